@@ -0,0 +1,229 @@
+// betweenness.h
+// -----------------------------------------------------------------------------
+// Betweenness centrality (Brandes) on top of the level-synchronous BFS.
+// Used by bfs_par --bc (exact) and --bc --bc-samples K (approximate).
+// -----------------------------------------------------------------------------
+//
+// Sources are processed in batches of up to 64 with the bit-parallel
+// (multi-source) BFS idea: bit b of a vertex's 64-bit masks stands for source
+// b of the batch, so one sweep over the adjacency of a level advances all
+// sources that reach the vertex at that distance.
+//
+// Forward sweep, per level d (frontier F_d with masks fr[v]):
+//   A. discover: for v in F_d, w in out(v): nxt[w] |= fr[v] & ~seen[w];
+//      the thread whose fetch_or finds nxt[w] == 0 appends w to its buffer,
+//      and the buffers are merged into F_{d+1} as in bfs_openmp_level
+//   B. path counts: for w in F_{d+1}, v in in(w), b in fr[v] & nxt[w]:
+//      sigma[w][b] += sigma[v][b]   (pull, so every w is written by one thread)
+// Every level's vertex list and masks are kept for the backward sweep.
+//
+// Backward sweep, d = D-1 .. 0: scatter the masks of level d+1, then for v in
+// F_d, w in out(v), b in mask_d(v) & mask_{d+1}(w):
+//   delta[v][b] += sigma[v][b] / sigma[w][b] * (1 + delta[w][b])
+// Each v is written by one thread only. Both sweeps size their thread team
+// per level from the frontier's edge count with the level engine's grain (see
+// LevelTuning in bfs_kernels.h), so small levels run serially.
+//
+// Memory: 2 * n * batch doubles for sigma/delta (batch 16 on a 1.1M-vertex
+// graph: ~280 MiB); only the entries a batch touched are cleared afterwards.
+// Undirected scores are halved (each pair counted once); sampled runs are
+// scaled by candidates / samples.
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include "graph_utils.h"
+#include "mem_utils.h"
+#include "bfs_kernels.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+using namespace std;
+
+static const int kBcMaxBatch = 64;
+
+// Serial Brandes, one source at a time; the reference for the batched engine.
+inline vector<double> betweenness_serial(const Graph& g, const vector<int>& sources, bool directed) {
+    const int n = g.size();
+    vector<double> bc(n, 0.0), sigma(n, 0.0), delta(n, 0.0);
+    vector<int> dist(n, -1), q;
+    q.reserve(n);
+    for (int s : sources) {
+        q.clear();
+        q.push_back(s); dist[s] = 0; sigma[s] = 1;
+        for (size_t h = 0; h < q.size(); ++h) {
+            int v = q[h];
+            for (int w : g[v]) {
+                if (dist[w] < 0) { dist[w] = dist[v] + 1; q.push_back(w); }
+                if (dist[w] == dist[v] + 1) sigma[w] += sigma[v];
+            }
+        }
+        for (size_t h = q.size(); h-- > 0; ) {
+            int v = q[h];
+            for (int w : g[v])
+                if (dist[w] == dist[v] + 1) delta[v] += sigma[v] / sigma[w] * (1 + delta[w]);
+            if (v != s) bc[v] += delta[v];
+        }
+        for (int v : q) { dist[v] = -1; sigma[v] = 0; delta[v] = 0; }
+    }
+    if (!directed) for (double& x : bc) x /= 2;
+    return bc;
+}
+
+// Batched, level-parallel Brandes. `in` holds the in-neighbors (the graph
+// itself when undirected, transpose(g) otherwise).
+inline vector<double> betweenness(const Graph& g, const Graph& in, const vector<int>& sources,
+                                  bool directed, int batch = 16) {
+    const int n = g.size();
+    const int B = max(1, min(batch, kBcMaxBatch));
+    int P = 1;
+    #ifdef _OPENMP
+    P = omp_get_max_threads();
+    #endif
+    const int64_t grain = level_tuning().grain;
+    auto team = [&](int64_t edges) { return (int)max<int64_t>(1, min<int64_t>(P, edges / grain)); };
+
+    vector<double> bc(n, 0.0);
+    page_vector<uint64_t> seen(n), fr(n), nxt(n);
+    page_vector<double> sigma(size_t(n) * B), delta(size_t(n) * B);
+    first_touch_fill(seen.data(), seen.size(), uint64_t(0));
+    first_touch_fill(fr.data(), fr.size(), uint64_t(0));
+    first_touch_fill(nxt.data(), nxt.size(), uint64_t(0));
+    first_touch_fill(sigma.data(), sigma.size(), 0.0);
+    first_touch_fill(delta.data(), delta.size(), 0.0);
+    uint64_t* seen_p = seen.data(); uint64_t* fr_p = fr.data(); uint64_t* nxt_p = nxt.data();
+    double* sig = sigma.data(); double* del = delta.data();
+    mem_footprint().add("masks", bytes_of(seen) + bytes_of(fr) + bytes_of(nxt));
+    mem_footprint().add("sigma_delta", bytes_of(sigma) + bytes_of(delta));
+
+    vector<vector<int>> lv_vert;        // vertices of each level
+    vector<vector<uint64_t>> lv_mask;   // and the sources that reach them there
+
+    for (size_t b0 = 0; b0 < sources.size(); b0 += B) {
+        const int k = (int)min<size_t>(B, sources.size() - b0);
+        lv_vert.clear(); lv_mask.clear();
+
+        // Level 0: the batch's sources
+        vector<int> F;
+        vector<uint64_t> FM;
+        int64_t f_edges = 0;
+        for (int b = 0; b < k; ++b) {
+            const int s = sources[b0 + b];
+            if (!fr_p[s]) { F.push_back(s); f_edges += g.degree(s); }
+            fr_p[s] |= uint64_t(1) << b;
+            seen_p[s] |= uint64_t(1) << b;
+            sig[size_t(s) * B + b] = 1;
+        }
+        for (int v : F) FM.push_back(fr_p[v]);
+
+        while (!F.empty()) {
+            lv_vert.push_back(F);
+            lv_mask.push_back(FM);
+
+            // A. discover the next level
+            const int T = team(f_edges);
+            vector<vector<int>> tls(T);
+            int64_t next_edges = 0;
+            #pragma omp parallel num_threads(T) if(T > 1) reduction(+:next_edges)
+            {
+                int tid = 0;
+                #ifdef _OPENMP
+                tid = omp_get_thread_num();
+                #endif
+                auto& out = tls[tid];
+                #pragma omp for schedule(dynamic, 256)
+                for (size_t i = 0; i < F.size(); ++i) {
+                    const int v = F[i];
+                    const uint64_t mv = fr_p[v];
+                    for (int w : g[v]) {
+                        const uint64_t m = mv & ~seen_p[w];
+                        if (m && !__atomic_fetch_or(&nxt_p[w], m, __ATOMIC_RELAXED)) {
+                            out.push_back(w);
+                            next_edges += g.degree(w);
+                        }
+                    }
+                }
+            }
+            vector<int> N;
+            for (auto& t : tls) N.insert(N.end(), t.begin(), t.end());
+
+            // B. path counts of the next level, pulled from in-neighbors
+            [[maybe_unused]] const int TB = team(next_edges);
+            #pragma omp parallel for num_threads(TB) if(TB > 1) schedule(dynamic, 256)
+            for (size_t j = 0; j < N.size(); ++j) {
+                const int w = N[j];
+                const uint64_t mw = nxt_p[w];
+                double* sw = sig + size_t(w) * B;
+                for (int v : in[w]) {
+                    uint64_t c = fr_p[v] & mw;
+                    const double* sv = sig + size_t(v) * B;
+                    while (c) { const int b = __builtin_ctzll(c); c &= c - 1; sw[b] += sv[b]; }
+                }
+            }
+
+            // Advance: F_{d+1} becomes the frontier
+            for (int v : F) fr_p[v] = 0;
+            vector<uint64_t> NM(N.size());
+            for (size_t j = 0; j < N.size(); ++j) {
+                const int w = N[j];
+                fr_p[w] = NM[j] = nxt_p[w];
+                seen_p[w] |= nxt_p[w];
+                nxt_p[w] = 0;
+            }
+            F.swap(N);
+            FM.swap(NM);
+            f_edges = next_edges;
+        }
+
+        // Backward sweep; nxt holds the masks of level d + 1
+        for (int d = (int)lv_vert.size() - 2; d >= 0; --d) {
+            const vector<int>& up = lv_vert[d + 1];
+            for (size_t j = 0; j < up.size(); ++j) nxt_p[up[j]] = lv_mask[d + 1][j];
+
+            const vector<int>& V = lv_vert[d];
+            const vector<uint64_t>& VM = lv_mask[d];
+            int64_t edges = 0;
+            for (int v : V) edges += g.degree(v);
+            [[maybe_unused]] const int T = team(edges);
+            #pragma omp parallel for num_threads(T) if(T > 1) schedule(dynamic, 256)
+            for (size_t i = 0; i < V.size(); ++i) {
+                const int v = V[i];
+                const double* sv = sig + size_t(v) * B;
+                double* dv = del + size_t(v) * B;
+                for (int w : g[v]) {
+                    uint64_t c = VM[i] & nxt_p[w];
+                    if (!c) continue;
+                    const double* sw = sig + size_t(w) * B;
+                    const double* dw = del + size_t(w) * B;
+                    while (c) {
+                        const int b = __builtin_ctzll(c); c &= c - 1;
+                        dv[b] += sv[b] / sw[b] * (1 + dw[b]);
+                    }
+                }
+            }
+            for (int w : up) nxt_p[w] = 0;
+        }
+
+        // Accumulate, then clear exactly what this batch touched
+        for (size_t d = 0; d < lv_vert.size(); ++d) {
+            const vector<int>& V = lv_vert[d];
+            const vector<uint64_t>& VM = lv_mask[d];
+            for (size_t i = 0; i < V.size(); ++i) {
+                const int v = V[i];
+                uint64_t c = VM[i];
+                while (c) {
+                    const int b = __builtin_ctzll(c); c &= c - 1;
+                    const size_t at = size_t(v) * B + b;
+                    if (v != sources[b0 + b]) bc[v] += del[at];
+                    sig[at] = 0; del[at] = 0;
+                }
+                seen_p[v] = 0; fr_p[v] = 0;
+            }
+        }
+    }
+    if (!directed) for (double& x : bc) x /= 2;
+    return bc;
+}
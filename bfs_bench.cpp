@@ -0,0 +1,421 @@
+// bfs_bench.cpp
+// -----------------------------------------------------------------------------
+// Thread-scaling sweep: regenerates the tables of results.txt in one process.
+// - Sweeps graphs (synthetic sizes and/or an edge-list file), parallel engines
+//   and thread counts; bfs_seq is measured once per graph as the baseline.
+// - Every configuration gets warmup runs, which also size a sample so that it
+//   lasts at least kMinSample (tiny graphs run several BFS per sample).
+// - Samples are repeated until the 95% confidence interval of the mean is
+//   within --ci of the mean (between --min-reps and --max-reps samples, at most
+//   --max-time seconds per configuration).
+// - Each engine's level array is validated (validate_bfs) once per thread count.
+// - Writes median, stddev and speedup tables as Markdown (stdout and --md) and
+//   one CSV row per configuration (--csv).
+//
+// Example (re-baseline a machine with one command):
+//   g++ -O3 -std=c++17 -fopenmp bfs_bench.cpp -o bfs_bench
+//   ./bfs_bench --sizes 10000,200000,1200000 --both --threads 1,2,4,8
+//               --engines level,owner,chunked --md results_new.md --csv results_new.csv
+//   ./bfs_bench --file com-youtube.ungraph.txt --n 1157828 --start 1
+// -----------------------------------------------------------------------------
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <map>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <cmath>
+#include "graph_utils.h"
+#include "bfs_kernels.h"
+#ifdef __linux__
+#include <sys/utsname.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+using namespace std;
+
+static const double kMinSample = 1e-3; // seconds; shorter runs are batched
+
+struct BenchOptions {
+    vector<int> sizes = {10000, 200000, 1200000};
+    int deg = 8;
+    bool directed = false;   // synthetic graphs keep edge direction
+    bool both = false;       // sweep each synthetic size undirected and directed
+    string file;             // optional edge-list graph (needs --n)
+    int file_n = 0;
+    int start = 0;
+    uint64_t seed = 42;
+    vector<string> engines = {"level"};
+    vector<int> threads = {1, 2, 4, 8};
+    int warmup = 2;
+    int min_reps = 5;
+    int max_reps = 100;
+    double ci = 0.02;        // target 95% CI half-width, relative to the mean
+    double max_time = 10.0;  // seconds of samples per configuration
+    string md, csv;
+};
+
+static void bench_usage(const char* prog) {
+    cerr << "Usage:\n"
+         << "  " << prog << " [--sizes 10000,200000,1200000] [--deg 8] [--directed | --both]\n"
+         << "  " << prog << " --file input.txt --n 1157828 [--start 1]\n"
+         << "Options: --engines level,owner,chunked --threads 1,2,4,8 --seed 42\n"
+         << "         --warmup 2 --min-reps 5 --max-reps 100 --ci 0.02 --max-time 10\n"
+         << "         --md out.md --csv out.csv\n";
+}
+
+static vector<string> split_list(const string& s) {
+    vector<string> out;
+    stringstream ss(s);
+    string item;
+    while (getline(ss, item, ','))
+        if (!item.empty()) out.push_back(item);
+    return out;
+}
+
+static vector<int> int_list(const string& s) {
+    vector<int> out;
+    for (const string& item : split_list(s)) out.push_back(atoi(item.c_str()));
+    return out;
+}
+
+static bool parse_bench_args(int argc, char** argv, BenchOptions& o) {
+    bool sizes_given = false;
+    for (int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        auto need = [&](int j){ return j + 1 < argc; };
+        if      (a == "--sizes"    && need(i)) { o.sizes = int_list(argv[++i]); sizes_given = true; }
+        else if (a == "--deg"      && need(i)) o.deg = atoi(argv[++i]);
+        else if (a == "--directed")            o.directed = true;
+        else if (a == "--both")                o.both = true;
+        else if (a == "--file"     && need(i)) o.file = argv[++i];
+        else if (a == "--n"        && need(i)) o.file_n = atoi(argv[++i]);
+        else if (a == "--start"    && need(i)) o.start = atoi(argv[++i]);
+        else if (a == "--seed"     && need(i)) o.seed = strtoull(argv[++i], nullptr, 10);
+        else if (a == "--engines"  && need(i)) o.engines = split_list(argv[++i]);
+        else if (a == "--threads"  && need(i)) o.threads = int_list(argv[++i]);
+        else if (a == "--warmup"   && need(i)) o.warmup = atoi(argv[++i]);
+        else if (a == "--min-reps" && need(i)) o.min_reps = atoi(argv[++i]);
+        else if (a == "--max-reps" && need(i)) o.max_reps = atoi(argv[++i]);
+        else if (a == "--ci"       && need(i)) o.ci = atof(argv[++i]);
+        else if (a == "--max-time" && need(i)) o.max_time = atof(argv[++i]);
+        else if (a == "--md"       && need(i)) o.md = argv[++i];
+        else if (a == "--csv"      && need(i)) o.csv = argv[++i];
+        else { bench_usage(argv[0]); return false; }
+    }
+    if (!o.file.empty() && !sizes_given) o.sizes.clear(); // file only
+
+    for (int s : o.sizes) if (s <= 0) { cerr << "Invalid --sizes\n"; return false; }
+    for (int t : o.threads) if (t <= 0) { cerr << "Invalid --threads\n"; return false; }
+    for (const string& e : o.engines)
+        if (!find_engine(e)) { cerr << "Unknown engine " << e << " in --engines\n"; return false; }
+    if (o.sizes.empty() && o.file.empty()) { cerr << "Nothing to run\n"; return false; }
+    if (!o.file.empty() && o.file_n <= 0)  { cerr << "--file needs --n\n"; return false; }
+    if (o.deg < 0)      { cerr << "Invalid --deg\n"; return false; }
+    if (o.start < 0)    { cerr << "Invalid --start\n"; return false; }
+    if (o.threads.empty() || o.engines.empty()) { cerr << "Empty --threads/--engines\n"; return false; }
+    if (o.warmup < 0 || o.min_reps < 2 || o.max_reps < o.min_reps)
+                        { cerr << "Invalid --warmup/--min-reps/--max-reps\n"; return false; }
+    if (o.ci <= 0 || o.max_time <= 0) { cerr << "Invalid --ci/--max-time\n"; return false; }
+    return true;
+}
+
+// Two-sided 95% Student t quantile for `df` degrees of freedom.
+static double t95(int df) {
+    static const double table[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+    if (df <= 0) return INFINITY;
+    if (df <= 30) return table[df - 1];
+    return df <= 60 ? 2.000 : df <= 120 ? 1.980 : 1.960;
+}
+
+// Per-run times of one configuration (seconds per BFS).
+struct Summary {
+    double median = 0, mean = 0, stddev = 0;
+    double ci_rel = 0;  // 95% CI half-width of the mean / mean
+    int samples = 0;
+    int batch = 1;      // BFS runs per sample
+};
+
+static Summary summarize(vector<double> x, int batch) {
+    Summary s;
+    s.samples = (int)x.size();
+    s.batch = batch;
+    sort(x.begin(), x.end());
+    const size_t k = x.size();
+    s.median = k % 2 ? x[k / 2] : 0.5 * (x[k / 2 - 1] + x[k / 2]);
+    for (double v : x) s.mean += v;
+    s.mean /= k;
+    double var = 0;
+    for (double v : x) var += (v - s.mean) * (v - s.mean);
+    s.stddev = k > 1 ? sqrt(var / (k - 1)) : 0.0;
+    s.ci_rel = s.mean > 0 ? t95((int)k - 1) * s.stddev / sqrt((double)k) / s.mean : 0.0;
+    return s;
+}
+
+// Warm up, size the batch, then sample until the CI target or a limit is hit.
+template <class F>
+static Summary measure(F run, const BenchOptions& o) {
+    double one = 0;
+    for (int k = 0; k < o.warmup; ++k) {
+        double t0 = wall();
+        run();
+        one = wall() - t0;
+    }
+    const int batch = one > 0 ? max(1, (int)ceil(kMinSample / one)) : 1;
+
+    vector<double> x;
+    double spent = 0;
+    while ((int)x.size() < o.max_reps) {
+        double t0 = wall();
+        for (int b = 0; b < batch; ++b) run();
+        double dt = wall() - t0;
+        x.push_back(dt / batch);
+        spent += dt;
+        if ((int)x.size() >= o.min_reps &&
+            (summarize(x, batch).ci_rel <= o.ci || spent >= o.max_time)) break;
+    }
+    return summarize(x, batch);
+}
+
+// One graph of the sweep.
+struct GraphSpec {
+    string type;     // "Synthetic" or the file name
+    int n = 0;
+    int deg = 0;     // requested average degree (synthetic only)
+    bool directed = false;
+};
+
+// One (graph, engine, thread count) measurement.
+struct Row {
+    GraphSpec spec;
+    int64_t edges = 0;
+    int start = 0;
+    string engine;
+    int threads = 1;
+    Summary seq, par;
+    bool ok = false;
+    double speedup() const { return par.median > 0 ? seq.median / par.median : 1.0; }
+};
+
+static string with_commas(int64_t v) {
+    string s = to_string(v);
+    for (int i = (int)s.size() - 3; i > 0; i -= 3) s.insert(i, ",");
+    return s;
+}
+
+// Input edges per vertex, the quantity --deg asks for (undirected edges are
+// stored twice in the CSR).
+static string avg_deg_str(const Row& r) {
+    if (r.spec.type == "Synthetic") return to_string(r.spec.deg);
+    ostringstream os;
+    os << fixed << setprecision(1)
+       << (double)r.edges / max(1, r.spec.n) / (r.spec.directed ? 1 : 2);
+    return os.str();
+}
+
+static string platform() {
+    string p;
+#ifdef __linux__
+    utsname u;
+    if (uname(&u) == 0) p = string(u.sysname) + " " + u.release + " " + u.machine;
+#endif
+    if (p.empty()) p = "unknown OS";
+#ifdef __VERSION__
+    p += string(", compiled with g++ ") + __VERSION__;
+#endif
+    return p;
+}
+
+// Markdown in the layout of results.txt: one table per graph and engine, then
+// a summary with the best thread count of each.
+static void write_markdown(ostream& out, const vector<Row>& rows, const BenchOptions& o,
+                           const string& cmdline) {
+    int procs = 1;
+    #ifdef _OPENMP
+    procs = omp_get_num_procs();
+    #endif
+    out << "# Parallel BFS — Thread-Scaling Sweep (bfs_bench)\n\n"
+        << "## Configuration Notes\n\n"
+        << "* Command: `" << cmdline << "`\n"
+        << "* Platform: " << platform() << "\n"
+        << "* Hardware threads: " << procs << "\n"
+        << "* Benchmarking Method: " << o.warmup << " warmup runs per configuration; samples of "
+        << "at least " << kMinSample * 1e3 << " ms repeated until the 95% CI half-width of the mean "
+        << "is within " << o.ci * 100 << "% (" << o.min_reps << " to " << o.max_reps
+        << " samples, at most " << o.max_time << " s). Times are medians per BFS run.\n\n---\n";
+
+    auto fmt = [](double v, int prec) {
+        ostringstream os; os << fixed << setprecision(prec) << v; return os.str();
+    };
+
+    for (size_t i = 0; i < rows.size(); ) {
+        size_t j = i;
+        while (j < rows.size() && rows[j].spec.type == rows[i].spec.type &&
+               rows[j].spec.n == rows[i].spec.n && rows[j].spec.directed == rows[i].spec.directed &&
+               rows[j].engine == rows[i].engine) ++j;
+        const Row& h = rows[i];
+        double best = 0;
+        for (size_t k = i; k < j; ++k) best = max(best, rows[k].speedup());
+
+        out << "\n## " << h.spec.type << (h.spec.directed ? " directed, " : " undirected, ")
+            << with_commas(h.spec.n) << " nodes — engine " << h.engine << "\n\n"
+            << "**Nodes:** " << with_commas(h.spec.n) << "\n"
+            << "**Avg Degree:** " << avg_deg_str(h) << "\n"
+            << "**Start:** " << h.start << "\n\n"
+            << "| Threads | Seq Time (s) | Seq Stddev (s) | Par Time (s) | Par Stddev (s) |   Speedup | Samples | CI95 | Level_check |\n"
+            << "| ------: | -----------: | -------------: | -----------: | -------------: | --------: | ------: | ---: | :---------: |\n";
+        for (size_t k = i; k < j; ++k) {
+            const Row& r = rows[k];
+            string sp = fmt(r.speedup(), 2) + "×";
+            if (j - i > 1 && r.speedup() == best) sp = "**" + sp + "**";
+            out << "| " << r.threads << " | " << fmt(r.seq.median, 6) << " | " << fmt(r.seq.stddev, 6)
+                << " | " << fmt(r.par.median, 6) << " | " << fmt(r.par.stddev, 6)
+                << " | " << sp << " | " << r.par.samples << " | " << fmt(r.par.ci_rel * 100, 1) << "%"
+                << " | " << (r.ok ? "OK" : "FAILED") << " |\n";
+        }
+        out << "\n---\n";
+        i = j;
+    }
+
+    // Best thread count of every (graph, engine)
+    out << "\n## Summary Table\n\n"
+        << "| Graph Type | Nodes | Avg Deg | Directed | Engine | Threads | Seq Time (s) | Par Time (s) |   Speedup |\n"
+        << "| ---------- | ----: | ------: | :------: | ------ | ------: | -----------: | -----------: | --------: |\n";
+    for (size_t i = 0; i < rows.size(); ) {
+        size_t j = i, b = i;
+        while (j < rows.size() && rows[j].spec.type == rows[i].spec.type &&
+               rows[j].spec.n == rows[i].spec.n && rows[j].spec.directed == rows[i].spec.directed &&
+               rows[j].engine == rows[i].engine) {
+            if (rows[j].speedup() > rows[b].speedup()) b = j;
+            ++j;
+        }
+        const Row& r = rows[b];
+        out << "| " << r.spec.type << " | " << with_commas(r.spec.n) << " | " << avg_deg_str(r)
+            << " | " << (r.spec.directed ? "Yes" : "No") << " | " << r.engine << " | " << r.threads
+            << " | " << fmt(r.seq.median, 6) << " | " << fmt(r.par.median, 6)
+            << " | " << fmt(r.speedup(), 2) << "× |\n";
+        i = j;
+    }
+}
+
+static void write_csv(ostream& out, const vector<Row>& rows) {
+    out << "graph,nodes,edges,avg_deg,directed,start,engine,threads,"
+           "seq_median_s,seq_stddev_s,seq_samples,par_median_s,par_mean_s,par_stddev_s,"
+           "par_ci95_rel,par_samples,par_batch,speedup,level_check\n";
+    out << setprecision(9);
+    for (const Row& r : rows)
+        out << r.spec.type << ',' << r.spec.n << ',' << r.edges << ',' << avg_deg_str(r) << ','
+            << (r.spec.directed ? 1 : 0) << ',' << r.start << ',' << r.engine << ',' << r.threads << ','
+            << r.seq.median << ',' << r.seq.stddev << ',' << r.seq.samples << ','
+            << r.par.median << ',' << r.par.mean << ',' << r.par.stddev << ','
+            << r.par.ci_rel << ',' << r.par.samples << ',' << r.par.batch << ','
+            << r.speedup() << ',' << (r.ok ? "OK" : "FAILED") << '\n';
+}
+
+int main(int argc, char** argv) {
+    ios::sync_with_stdio(false);
+
+    BenchOptions o;
+    if (!parse_bench_args(argc, argv, o)) return 1;
+    string cmdline = argv[0];
+    for (int i = 1; i < argc; ++i) cmdline += string(" ") + argv[i];
+
+    #ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+    #else
+    if (o.threads != vector<int>{1}) cerr << "Built without OpenMP: sweeping 1 thread only\n";
+    o.threads = {1};
+    #endif
+
+    vector<GraphSpec> specs;
+    for (int n : o.sizes) {
+        GraphSpec s; s.type = "Synthetic"; s.n = n; s.deg = o.deg;
+        if (o.both) { specs.push_back(s); s.directed = true; specs.push_back(s); }
+        else        { s.directed = o.directed; specs.push_back(s); }
+    }
+    if (!o.file.empty()) {
+        GraphSpec s;
+        size_t slash = o.file.find_last_of("/\\");
+        s.type = slash == string::npos ? o.file : o.file.substr(slash + 1);
+        s.n = o.file_n;
+        specs.push_back(s);
+    }
+
+    map<int, LevelTuning> tuning; // calibrated once per thread count
+    vector<Row> rows;
+    for (const GraphSpec& spec : specs) {
+        #ifdef _OPENMP
+        omp_set_num_threads(max_threads); // build with the full machine
+        #endif
+        Graph g;
+        if (spec.type == "Synthetic") {
+            g = make_synthetic_graph(spec.n, spec.deg, spec.directed, o.seed);
+        } else {
+            ifstream fin(o.file);
+            if (!fin) { cerr << "Failed to open " << o.file << "\n"; return 1; }
+            g = load_edgelist(fin, spec.n);
+        }
+
+        // Start vertex: --start, or the first vertex with an edge if it has none
+        int start = min(o.start, spec.n - 1);
+        if (g.degree(start) == 0)
+            for (int u = 0; u < spec.n; ++u) if (g.degree(u) > 0) { start = u; break; }
+
+        cerr << "[bench] " << spec.type << " n=" << spec.n
+             << (spec.directed ? " directed" : "") << " seq ..." << endl;
+        vector<int> lvl_seq;
+        const Summary seq = measure([&]{ bfs_seq(g, start, &lvl_seq); }, o);
+
+        for (const string& name : o.engines) {
+            const Engine* engine = find_engine(name);
+            for (int t : o.threads) {
+                #ifdef _OPENMP
+                omp_set_num_threads(t);
+                #endif
+                if (!tuning.count(t)) tuning[t] = calibrate_level_tuning();
+                level_tuning() = tuning[t];
+
+                Row r;
+                r.spec = spec; r.edges = g.num_edges(); r.start = start;
+                r.engine = name; r.threads = t; r.seq = seq;
+
+                page_vector<int> lvl_par;
+                engine->run(g, start, &lvl_par);
+                r.ok = validate_bfs(g, start, lvl_par);
+                for (int v = 0; v < spec.n && r.ok; ++v)
+                    if (lvl_par[v] != lvl_seq[v]) r.ok = false;
+
+                r.par = measure([&]{ engine->run(g, start, &lvl_par); }, o);
+                cerr << "[bench]   " << name << " T=" << t << fixed << setprecision(6)
+                     << " par=" << r.par.median << "s speedup=" << setprecision(2) << r.speedup()
+                     << " samples=" << r.par.samples << " ci=" << setprecision(1)
+                     << r.par.ci_rel * 100 << "%" << (r.ok ? "" : " FAILED") << endl;
+                cerr.unsetf(ios::floatfield);
+                rows.push_back(r);
+            }
+        }
+    }
+
+    write_markdown(cout, rows, o, cmdline);
+    if (!o.md.empty()) {
+        ofstream f(o.md);
+        if (!f) { cerr << "Failed to open " << o.md << "\n"; return 1; }
+        write_markdown(f, rows, o, cmdline);
+    }
+    if (!o.csv.empty()) {
+        ofstream f(o.csv);
+        if (!f) { cerr << "Failed to open " << o.csv << "\n"; return 1; }
+        write_csv(f, rows);
+    }
+
+    bool all_ok = true;
+    for (const Row& r : rows) all_ok = all_ok && r.ok;
+    return all_ok ? 0 : 1;
+}
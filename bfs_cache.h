@@ -0,0 +1,197 @@
+// bfs_cache.h
+// -----------------------------------------------------------------------------
+// LRU cache of single-source BFS results for the query server
+// (bfs_par --serve --cache-mb N).
+// -----------------------------------------------------------------------------
+//
+// A few hub sources usually produce most queries. Once a source has missed
+// --cache-admit times, the worker runs one full BFS from it and caches the
+// level of every vertex; from then on dist, path, khop and reach from that
+// source are lookups (path walks back from t over the reverse edges to a
+// vertex one level closer, so it needs no parent array).
+//
+// Entries (LevelEntry) are immutable and take the smaller of two encodings:
+//   dense   uint8 level per vertex (kLvInf = unreached), n bytes
+//   sparse  the reached vertices sorted, with their uint8 levels, 5 bytes per
+//           reached vertex (small reachable sets of directed graphs)
+// plus within[l], the vertices at level <= l, so khop is O(1). A BFS deeper
+// than 254 levels, or larger than a shard's budget, is not cached
+// (Cache_rejected) and its source is never admitted again, so a hot source
+// pays the full BFS once rather than on every request. An evicted source
+// starts counting misses from zero.
+//
+// Concurrency: the sources hash to lock-striped shards, each an LRU list with
+// its own mutex and an equal share of the --cache-mb budget; a lookup locks
+// one shard only long enough to move the entry to the front and copy its
+// shared_ptr. Readers hold that reference while they use the entry, so an
+// eviction by another thread never frees levels still being read (the RCU
+// grace period is the reference count). Per-source miss counters for the
+// admission rule are relaxed atomics outside the shards.
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+using namespace std;
+
+constexpr uint8_t kLvInf = 255;
+constexpr uint8_t kNeverAdmit = 255;   // miss counter of a rejected source
+
+// Levels of one BFS from `source`.
+struct LevelEntry {
+    int source = -1;
+    vector<uint8_t> dense;          // level per vertex; empty when sparse
+    vector<int> verts;              // sparse: reached vertices, sorted
+    vector<uint8_t> vlevel;         // sparse: level of verts[i]
+    vector<int64_t> within;         // within[l] = vertices at level <= l
+
+    // Level of v, -1 when unreached
+    int level(int v) const {
+        if (!dense.empty()) return dense[v] == kLvInf ? -1 : dense[v];
+        const auto it = lower_bound(verts.begin(), verts.end(), v);
+        return it != verts.end() && *it == v ? vlevel[it - verts.begin()] : -1;
+    }
+    int64_t within_k(int k) const { return within[min<size_t>((size_t)k, within.size() - 1)]; }
+    size_t bytes() const {
+        return sizeof(*this) + dense.capacity() + verts.capacity() * sizeof(int) + vlevel.capacity() +
+               within.capacity() * sizeof(int64_t);
+    }
+};
+
+// Entry from a BFS over n vertices: `order` lists the reached vertices by
+// non-decreasing level, depth[v] is the level of v. nullptr if a level > 254.
+inline shared_ptr<const LevelEntry> level_entry_build(int n, int source, const vector<int>& order,
+                                                     const vector<int>& depth) {
+    const int levels = depth[order.back()] + 1;
+    if (levels > kLvInf) return nullptr;
+    auto e = make_shared<LevelEntry>();
+    e->source = source;
+    e->within.assign(levels, 0);
+    for (int v : order) e->within[depth[v]]++;
+    for (int l = 1; l < levels; ++l) e->within[l] += e->within[l - 1];
+    if (order.size() * 5 < (size_t)n) {
+        e->verts = order;
+        sort(e->verts.begin(), e->verts.end());
+        e->vlevel.resize(order.size());
+        for (size_t i = 0; i < order.size(); ++i) e->vlevel[i] = (uint8_t)depth[e->verts[i]];
+    } else {
+        e->dense.assign(n, kLvInf);
+        for (int v : order) e->dense[v] = (uint8_t)depth[v];
+    }
+    return e;
+}
+
+class BfsCache {
+public:
+    // `budget` bytes over all shards; a source is admitted on its `admit`-th
+    // miss (1..254).
+    BfsCache(int n, size_t budget, int admit) : misses_(n), admit_(max(admit, 1)) {
+        for (auto& m : misses_) m.store(0, memory_order_relaxed);
+        // Enough shards to spread the lock traffic, few enough that a shard
+        // still holds several dense entries
+        const size_t dense = (size_t)n + sizeof(LevelEntry);
+        nshards_ = (int)max<size_t>(1, min<size_t>(kMaxShards, budget / (8 * dense)));
+        shard_budget_ = budget / nshards_;
+    }
+
+    // Cached levels of s, or nullptr (counts a hit or a miss)
+    shared_ptr<const LevelEntry> find(int s) {
+        Shard& sh = shard(s);
+        {
+            lock_guard<mutex> lk(sh.mu);
+            const auto it = sh.map.find(s);
+            if (it != sh.map.end()) {
+                sh.lru.splice(sh.lru.begin(), sh.lru, it->second);
+                hits_.fetch_add(1, memory_order_relaxed);
+                return *it->second;
+            }
+        }
+        misses_total_.fetch_add(1, memory_order_relaxed);
+        return nullptr;
+    }
+
+    // After a miss: has s missed often enough to be worth a full BFS?
+    bool admit(int s) {
+        atomic<uint8_t>& m = misses_[s];
+        const int c = m.load(memory_order_relaxed);
+        if (c == kNeverAdmit) return false;
+        if (c < kNeverAdmit - 1) m.store((uint8_t)(c + 1), memory_order_relaxed);
+        return c + 1 >= admit_;
+    }
+
+    // Inserts the entry of source s (unless s is already cached), evicting the
+    // least recently used ones of its shard until the shard fits its budget.
+    // Entries larger than a shard's budget, or nullptr (too deep), count as
+    // rejected and s is not admitted again.
+    void insert(int s, shared_ptr<const LevelEntry> e) {
+        if (!e || e->bytes() > shard_budget_) {
+            misses_[s].store(kNeverAdmit, memory_order_relaxed);
+            rejected_.fetch_add(1, memory_order_relaxed);
+            return;
+        }
+        const size_t b = e->bytes();
+        Shard& sh = shard(s);
+        lock_guard<mutex> lk(sh.mu);
+        const auto it = sh.map.find(e->source);
+        if (it != sh.map.end()) {              // another worker was first
+            sh.lru.splice(sh.lru.begin(), sh.lru, it->second);
+            return;
+        }
+        while (sh.bytes + b > shard_budget_ && !sh.lru.empty()) {
+            const LevelEntry& old = *sh.lru.back();
+            sh.bytes -= old.bytes();
+            sh.map.erase(old.source);
+            misses_[old.source].store(0, memory_order_relaxed);
+            sh.lru.pop_back();
+            evictions_.fetch_add(1, memory_order_relaxed);
+        }
+        sh.lru.push_front(move(e));
+        sh.map[sh.lru.front()->source] = sh.lru.begin();
+        sh.bytes += b;
+        inserts_.fetch_add(1, memory_order_relaxed);
+    }
+
+    struct Stats {
+        int64_t hits = 0, misses = 0, inserts = 0, evictions = 0, rejected = 0;
+        int64_t entries = 0, bytes = 0;
+        double hit_rate() const { return hits + misses ? (double)hits / (hits + misses) : 0.0; }
+    };
+    Stats stats() {
+        Stats s;
+        s.hits = hits_; s.misses = misses_total_; s.inserts = inserts_;
+        s.evictions = evictions_; s.rejected = rejected_;
+        for (int i = 0; i < nshards_; ++i) {
+            lock_guard<mutex> lk(shards_[i].mu);
+            s.entries += (int64_t)shards_[i].lru.size();
+            s.bytes += (int64_t)shards_[i].bytes;
+        }
+        return s;
+    }
+    size_t budget() const { return shard_budget_ * nshards_; }
+    int shards() const { return nshards_; }
+
+private:
+    static constexpr int kMaxShards = 64;
+    using Lru = list<shared_ptr<const LevelEntry>>;
+    struct alignas(64) Shard {
+        mutex mu;
+        Lru lru;                               // most recently used first
+        unordered_map<int, Lru::iterator> map;
+        size_t bytes = 0;
+    };
+
+    Shard& shard(int s) { return shards_[((uint32_t)s * 0x9e3779b1u >> 16) % (uint32_t)nshards_]; }
+
+    Shard shards_[kMaxShards];
+    vector<atomic<uint8_t>> misses_;
+    int admit_;
+    int nshards_ = 1;
+    size_t shard_budget_ = 0;
+    atomic<int64_t> hits_{0}, misses_total_{0}, inserts_{0}, evictions_{0}, rejected_{0};
+};
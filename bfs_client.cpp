@@ -0,0 +1,233 @@
+// bfs_client.cpp
+// -----------------------------------------------------------------------------
+// Load generator for the query server (bfs_par --serve <socket>).
+// - Opens --connections Unix socket connections, one thread each, and sends
+//   --requests random queries per connection (vertex IDs drawn from the
+//   server's "info" reply, --seed per connection).
+// - --op picks the request type (dist, path, khop, reach) or mix (uniformly
+//   random per request); khop uses --k hops.
+// - --hot H --hot-frac F draws the source of a fraction F of the requests from
+//   H fixed hub vertices (the same for all connections), the skew a server
+//   BFS cache (--cache-mb) is meant for.
+// - With --pipeline P a connection keeps P requests in flight: it writes P
+//   lines, then reads the P responses. A request's latency runs from the write
+//   of its batch to the arrival of its response line.
+// - Reports throughput, latency percentiles and error responses; --shutdown
+//   stops the server afterwards.
+//
+// Example:
+//   g++ -O3 -std=c++17 -fopenmp bfs_openmp.cpp -o bfs_par
+//   g++ -O3 -std=c++17 -pthread bfs_client.cpp -o bfs_client
+//   ./bfs_par --n 1157828 --start 1 --file com-youtube.ungraph.txt --serve /tmp/bfs.sock &
+//   ./bfs_client --socket /tmp/bfs.sock --connections 4 --requests 20000 --op mix --shutdown
+// -----------------------------------------------------------------------------
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <chrono>
+#include <iomanip>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+struct ClientOptions {
+    string socket;
+    int connections = 4;
+    int requests = 10000;    // per connection
+    string op = "mix";       // dist, path, khop, reach or mix
+    int k = 2;               // hops for khop
+    int pipeline = 1;        // requests in flight per connection
+    uint64_t seed = 42;
+    int hot = 0;             // hot sources, 0: uniform
+    double hot_frac = 0.9;
+    bool shutdown = false;
+};
+
+static bool parse_client_args(int argc, char** argv, ClientOptions& opt) {
+    auto need = [&](int i) { return i + 1 < argc; };
+    for (int i = 1; i < argc; ++i) {
+        const string a = argv[i];
+        if      (a == "--socket"      && need(i)) opt.socket = argv[++i];
+        else if (a == "--connections" && need(i)) opt.connections = atoi(argv[++i]);
+        else if (a == "--requests"    && need(i)) opt.requests = atoi(argv[++i]);
+        else if (a == "--op"          && need(i)) opt.op = argv[++i];
+        else if (a == "--k"           && need(i)) opt.k = atoi(argv[++i]);
+        else if (a == "--pipeline"    && need(i)) opt.pipeline = atoi(argv[++i]);
+        else if (a == "--seed"        && need(i)) opt.seed = strtoull(argv[++i], nullptr, 10);
+        else if (a == "--hot"         && need(i)) opt.hot = atoi(argv[++i]);
+        else if (a == "--hot-frac"    && need(i)) opt.hot_frac = atof(argv[++i]);
+        else if (a == "--shutdown") opt.shutdown = true;
+        else {
+            cerr << "Usage: " << argv[0] << " --socket path [--connections 4] [--requests 10000]\n"
+                 << "       [--op dist|path|khop|reach|mix] [--k 2] [--pipeline 1] [--seed 42]\n"
+                 << "       [--hot 0] [--hot-frac 0.9] [--shutdown]\n";
+            return false;
+        }
+    }
+    if (opt.socket.empty()) { cerr << "--socket is required\n"; return false; }
+    if (opt.connections <= 0 || opt.requests <= 0 || opt.pipeline <= 0 || opt.k < 0 ||
+        opt.hot < 0 || opt.hot_frac < 0 || opt.hot_frac > 1) {
+        cerr << "Invalid count\n";
+        return false;
+    }
+    if (opt.op != "dist" && opt.op != "path" && opt.op != "khop" && opt.op != "reach" && opt.op != "mix") {
+        cerr << "Invalid --op\n";
+        return false;
+    }
+    return true;
+}
+
+static double now() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+// A connected socket with line-buffered reads.
+struct Connection {
+    int fd = -1;
+    string buf;
+
+    bool open(const string& path) {
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) return false;
+        memcpy(addr.sun_path, path.c_str(), path.size());
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        return fd >= 0 && connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0;
+    }
+    bool send_all(const string& s) {
+        for (size_t off = 0; off < s.size(); ) {
+            const ssize_t w = ::send(fd, s.data() + off, s.size() - off, 0);
+            if (w <= 0) return false;
+            off += (size_t)w;
+        }
+        return true;
+    }
+    bool read_line(string& line) {
+        size_t nl;
+        char tmp[65536];
+        while ((nl = buf.find('\n')) == string::npos) {
+            const ssize_t r = recv(fd, tmp, sizeof(tmp), 0);
+            if (r <= 0) return false;
+            buf.append(tmp, (size_t)r);
+        }
+        line.assign(buf, 0, nl);
+        buf.erase(0, nl + 1);
+        return true;
+    }
+    ~Connection() { if (fd >= 0) close(fd); }
+};
+
+struct ConnResult {
+    vector<double> latency;
+    int64_t errors = 0;
+    bool ok = true;
+};
+
+static void run_connection(const ClientOptions& opt, int id, int n, ConnResult& res) {
+    static const char* const ops[] = {"dist", "path", "khop", "reach"};
+    Connection c;
+    if (!c.open(opt.socket)) { res.ok = false; return; }
+    mt19937_64 rng(opt.seed + (uint64_t)id * 7919);
+    uniform_int_distribution<int> pick(0, n - 1);
+    uniform_int_distribution<int> pick_op(0, 3);
+    uniform_real_distribution<double> coin(0, 1);
+    mt19937_64 hot_rng(opt.seed);                  // same hubs on every connection
+    vector<int> hot(opt.hot);
+    for (int& h : hot) h = pick(hot_rng);
+    uniform_int_distribution<int> pick_hot(0, max(opt.hot - 1, 0));
+    res.latency.reserve(opt.requests);
+    string batch, line;
+    for (int done = 0; done < opt.requests; ) {
+        const int cnt = min(opt.pipeline, opt.requests - done);
+        batch.clear();
+        for (int i = 0; i < cnt; ++i) {
+            const string op = opt.op == "mix" ? ops[pick_op(rng)] : opt.op;
+            const int s = !hot.empty() && coin(rng) < opt.hot_frac ? hot[pick_hot(rng)] : pick(rng);
+            const int t = op == "khop" ? opt.k : pick(rng);
+            batch += op + " " + to_string(s) + " " + to_string(t) + "\n";
+        }
+        const double t0 = now();
+        if (!c.send_all(batch)) { res.ok = false; return; }
+        for (int i = 0; i < cnt; ++i) {
+            if (!c.read_line(line)) { res.ok = false; return; }
+            res.latency.push_back(now() - t0);
+            if (line.compare(0, 5, "error") == 0) res.errors++;
+        }
+        done += cnt;
+    }
+}
+#endif
+
+int main(int argc, char** argv) {
+    ClientOptions opt;
+    if (!parse_client_args(argc, argv, opt)) return 1;
+#if defined(__unix__) || defined(__APPLE__)
+    // Graph size from the server
+    int n = 0;
+    {
+        Connection c;
+        string line;
+        if (!c.open(opt.socket) || !c.send_all("info\n") || !c.read_line(line)) {
+            cerr << "Cannot reach the server at " << opt.socket << "\n";
+            return 1;
+        }
+        const size_t p = line.find("n=");
+        if (p != string::npos) n = atoi(line.c_str() + p + 2);
+        if (n <= 0) { cerr << "Unexpected info reply: " << line << "\n"; return 1; }
+        cout << "Server_" << line.substr(0, line.find(' ')) << "=" << line.substr(line.find(' ') + 1) << "\n";
+    }
+
+    vector<ConnResult> res(opt.connections);
+    vector<thread> threads;
+    const double t0 = now();
+    for (int i = 0; i < opt.connections; ++i)
+        threads.emplace_back(run_connection, cref(opt), i, n, ref(res[i]));
+    for (thread& t : threads) t.join();
+    const double t1 = now();
+
+    vector<double> lat;
+    int64_t errors = 0;
+    bool ok = true;
+    for (const ConnResult& r : res) {
+        lat.insert(lat.end(), r.latency.begin(), r.latency.end());
+        errors += r.errors;
+        ok = ok && r.ok;
+    }
+    if (!ok) cerr << "Some connections failed\n";
+    sort(lat.begin(), lat.end());
+    double sum = 0;
+    for (double x : lat) sum += x;
+    const size_t m = max<size_t>(lat.size(), 1);
+
+    cout << fixed << setprecision(3);
+    cout << "Client_connections=" << opt.connections << " Client_pipeline=" << opt.pipeline
+         << " Client_op=" << opt.op << " Client_hot=" << opt.hot << "\n";
+    cout << "Client_requests=" << lat.size() << " Client_errors=" << errors
+         << " Client_time_s=" << (t1 - t0) << " Client_qps=" << setprecision(0) << lat.size() / (t1 - t0) << "\n";
+    cout << setprecision(3) << "Client_us_mean=" << 1e6 * sum / m
+         << " Client_us_p50=" << (lat.empty() ? 0 : 1e6 * lat[lat.size() / 2])
+         << " Client_us_p99=" << (lat.empty() ? 0 : 1e6 * lat[min(lat.size() - 1, lat.size() * 99 / 100)])
+         << " Client_us_max=" << (lat.empty() ? 0 : 1e6 * lat.back()) << "\n";
+
+    if (opt.shutdown) {
+        Connection c;
+        if (c.open(opt.socket)) c.send_all("shutdown\n");
+    }
+    return ok ? 0 : 1;
+#else
+    cerr << "bfs_client needs POSIX sockets\n";
+    return 1;
+#endif
+}
@@ -0,0 +1,588 @@
+// bfs_kernels.h
+// -----------------------------------------------------------------------------
+// BFS kernels shared by bfs_openmp.cpp (bfs_par) and bfs_bench.cpp (bfs_bench):
+// the sequential reference, the parallel engines selectable with --engine, the
+// per-level thread-count calibration of the level engine, and Graph500-style
+// validation of a level array. Every traversal records the bytes of its
+// visited, level, order and frontier buffers in mem_footprint().
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include "graph_utils.h"
+#include "mem_utils.h"
+#include "bfs_stats.h"
+#include "bfs_trace.h"
+#include "perf_counters.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+using namespace std;
+
+// Reuse the sequential BFS to (1) compare times and (2) verify correctness by
+// comparing the level arrays (where nodes are reachable).
+inline vector<int> bfs_seq(const Graph& g, int s, vector<int>* level_out = nullptr) {
+    const int n = (int)g.size();
+    vector<char> vis(n, 0);
+    vector<int> q;      q.reserve(n);
+    vector<int> order;  order.reserve(n);
+    vector<int> level(n, -1);
+
+    vis[s] = 1; level[s] = 0; q.push_back(s);
+    for (size_t h = 0; h < q.size(); ++h) {
+        int u = q[h];
+        order.push_back(u);
+        for (int v : g[u]) {
+            if (!vis[v]) {
+                vis[v] = 1;
+                level[v] = level[u] + 1;
+                q.push_back(v);
+            }
+        }
+    }
+    Footprint& fp = mem_footprint();
+    fp.add("visited", bytes_of(vis)); fp.add("level", bytes_of(level));
+    fp.add("order", bytes_of(order)); fp.add("frontier", bytes_of(q));
+    if (level_out) *level_out = std::move(level);
+    return order;
+}
+
+// Small wall-clock helper that uses omp_get_wtime() when available.
+inline double wall() {
+    #ifdef _OPENMP
+    return omp_get_wtime();
+    #else
+    using clk = chrono::steady_clock; static auto t0 = clk::now();
+    return chrono::duration<double>(clk::now() - t0).count();
+    #endif
+}
+
+// Per-level parallelism for bfs_openmp_level. A level whose frontier has fewer
+// than `grain` outgoing edges is expanded serially; larger levels get one
+// thread per `grain` edges, up to the full team. Measured once per process on
+// the current machine (--grain overrides):
+// - edge_s:      serial check-and-claim cost of one edge (random visited access)
+// - team_speedup: the same loop with atomic exchange on the full team
+// - fork_join_s: an empty parallel region on the full team
+// Forking T threads pays off once E * edge_s * (1 - 1/speedup) > fork_join_s;
+// the grain doubles that break-even point. Without a real speedup (one core,
+// oversubscription) every level stays serial.
+struct LevelTuning {
+    int64_t grain = 0;          // frontier edges per thread
+    double fork_join_s = 0;
+    double edge_s = 0;
+    double team_speedup = 1;
+};
+
+inline LevelTuning calibrate_level_tuning() {
+    LevelTuning t;
+    t.grain = INT64_MAX;
+    int P = 1;
+    #ifdef _OPENMP
+    P = omp_get_max_threads();
+    #endif
+    if (P == 1) return t; // never worth forking
+
+    // Fork/join: best of a few empty regions after a warm-up
+    volatile int sink = 0;
+    double best = 1e9;
+    for (int r = 0; r < 20; ++r) {
+        double t0 = wall();
+        #pragma omp parallel
+        { if (sink < 0) sink = 1; }
+        if (r >= 2) best = min(best, wall() - t0);
+    }
+    t.fork_join_s = best;
+
+    // Per-edge cost: random visited checks over an out-of-L2 array, serial
+    // with plain stores and parallel with atomic exchange
+    const int m = 1 << 22, vn = 1 << 22;
+    vector<int> nbr(m);
+    uint64_t x = 88172645463325252ull;
+    for (int i = 0; i < m; ++i) { x ^= x << 13; x ^= x >> 7; x ^= x << 17; nbr[i] = (int)(x % vn); }
+    vector<atomic<uint8_t>> vis(vn);
+    int64_t claimed = 0;
+
+    for (auto& f : vis) f.store(0, memory_order_relaxed);
+    double t0 = wall();
+    for (int v : nbr)
+        if (!vis[v].load(memory_order_relaxed)) { vis[v].store(1, memory_order_relaxed); ++claimed; }
+    const double ts = wall() - t0;
+    t.edge_s = ts / m;
+
+    for (auto& f : vis) f.store(0, memory_order_relaxed);
+    t0 = wall();
+    #pragma omp parallel for schedule(static) reduction(+:claimed)
+    for (int i = 0; i < m; ++i)
+        if (!vis[nbr[i]].exchange(1, memory_order_relaxed)) ++claimed;
+    const double tp = max(wall() - t0, 1e-9);
+    sink = (int)(claimed & 1);
+    t.team_speedup = ts / tp;
+
+    if (t.team_speedup > 1.1) {
+        double gain = t.edge_s * (1.0 - 1.0 / t.team_speedup);
+        t.grain = max<int64_t>(256, (int64_t)(2.0 * t.fork_join_s / gain));
+    }
+    return t;
+}
+
+// Grain fixed by set_level_grain(); 0 = calibrate.
+inline int64_t& level_grain_override() { static int64_t g = 0; return g; }
+
+// Measured on first use unless a grain was set; call early (before timing) to
+// keep it out of the runs.
+inline LevelTuning& level_tuning() {
+    static LevelTuning t = [] {
+        if (level_grain_override() <= 0) return calibrate_level_tuning();
+        LevelTuning fixed;
+        fixed.grain = level_grain_override();
+        return fixed;
+    }();
+    return t;
+}
+
+// --grain: use `grain` edges per thread; before the first level_tuning() call
+// this also skips the calibration probe.
+inline void set_level_grain(int64_t grain) {
+    level_grain_override() = grain;
+    level_tuning().grain = grain;
+}
+
+// Level-synchronous parallel BFS:
+// - 'frontier' contains current-level nodes; 'frontier_edges' is the sum of
+//   their degrees, accumulated when they are discovered.
+// - Each level picks a thread count from frontier_edges (see LevelTuning).
+//   With one thread the level is expanded serially without atomics or merge,
+//   which keeps small graphs and 1-thread runs at bfs_seq speed.
+// - Otherwise threads expand neighbors of nodes in 'frontier' concurrently.
+// - 'visited[v].exchange(1)' returns previous value; only the first thread that
+//   flips from 0 to 1 enqueues v into its local buffer.
+// - After the parallel region, we merge all per-thread buffers to form next level.
+// - 'visited' and 'level' are first-touched in parallel with a static schedule,
+//   so their pages are spread over the NUMA nodes of the threads.
+// - Built with -DBFS_INSTRUMENT, per-level counters and timers go to bfs_stats().
+// - With --perf, hardware counter deltas per level go to perf_counters().levels.
+// - Built with -DBFS_TRACE and run with --trace, per-thread chunk, barrier and
+//   merge events go to bfs_tracer().
+inline vector<int> bfs_openmp_level(const Graph& g, int s, page_vector<int>* level_out = nullptr) {
+    const int n = (int)g.size();
+    int P = 1;
+    #ifdef _OPENMP
+    P = omp_get_max_threads();
+    #endif
+    const int64_t grain = level_tuning().grain;
+    BFS_TRC(Tracer& tr = bfs_tracer(); const bool tr_on = tr.enabled(); const double t_bfs = wall();
+            const int kChunk = 512;) // the dynamic schedule's chunk size below
+
+    page_vector<atomic<uint8_t>> visited(n); // atomic visited flags 0 or 1
+    page_vector<int> level(n);               // level of each node (-1 means unvisited)
+    #pragma omp parallel for schedule(static) if(P > 1 && n >= grain)
+    for (int i = 0; i < n; ++i) {
+        visited[i].store(0, memory_order_relaxed);
+        level[i] = -1;
+    }
+
+    page_vector<int> frontier; frontier.reserve(1024); // current level's frontier
+    page_vector<int> next;     next.reserve(1024);     // next level, reused across levels
+    vector<int> order;    order.reserve(n);   // order of visitation
+
+    // Raw pointers for the hot loops: visited/level escape into the parallel
+    // regions, so indexing the vectors would reload data() on every edge.
+    atomic<uint8_t>* vis = visited.data();
+    int* lvl = level.data();
+
+    visited[s].store(1, memory_order_relaxed);
+    level[s] = 0; 
+    frontier.push_back(s);
+    int64_t frontier_edges = g.degree(s);
+    int curr_level = 0;
+    size_t tls_peak = 0; // largest total of the per-thread buffers of one level
+    BFS_STAT(TraversalStats& stats = bfs_stats(); stats.levels.clear();)
+    PerfCounters& pc = perf_counters();
+    const bool perf_on = pc.available();
+    if (perf_on) pc.levels.clear();
+
+    while (!frontier.empty()) {
+        PerfSample perf0;
+        if (perf_on) perf0 = pc.read();
+        // record traversal order 
+        order.insert(order.end(), frontier.begin(), frontier.end());
+
+        const int T = (int)min<int64_t>(P, frontier_edges / grain);
+        int64_t next_edges = 0;
+        next.clear();
+        BFS_STAT(LevelStats L; L.level = curr_level; L.threads = max(T, 1);
+                 L.frontier = (int64_t)frontier.size(); L.per_thread.resize(L.threads);
+                 const double t_level = wall();)
+        BFS_TRC(const double t_lvl = wall();)
+
+        if (T <= 1) {
+            // Serial fast path: plain load/store instead of exchange, no merge
+            for (int u : frontier) {
+                BFS_STAT(L.per_thread[0].edges += g.degree(u);)
+                for (int v : g[u]) {
+                    if (!vis[v].load(memory_order_relaxed)) {
+                        vis[v].store(1, memory_order_relaxed);
+                        lvl[v] = curr_level + 1;
+                        next.push_back(v);
+                        if (P > 1) next_edges += g.degree(v);
+                    }
+                }
+            }
+            BFS_STAT(ThreadLevelStats& T0 = L.per_thread[0];
+                     T0.claims = (int64_t)next.size(); T0.failed = T0.edges - T0.claims;
+                     L.expand_s = T0.busy_s = wall() - t_level;)
+            BFS_TRC(if (tr_on) tr.record(0, "serial_level", t_lvl, wall(), curr_level,
+                                         (int64_t)frontier.size());)
+        } else {
+            // per-thread buffers to avoid pushing into a shared vector
+            vector<page_vector<int>> tls(T); // thread-local storage for next frontier
+            for (int t = 0; t < T; ++t) tls[t].reserve(frontier.size() / (T + 1) + 16); // heuristic estimate per thread 
+
+            // Parallel expansion of the current frontier
+            #pragma omp parallel num_threads(T) reduction(+:next_edges)
+            {
+                int tid = 0;
+                #ifdef _OPENMP
+                tid = omp_get_thread_num();
+                #endif
+                auto& out = tls[tid];
+                BFS_STAT(ThreadLevelStats my; const double t_busy = wall();)
+                BFS_TRC(double t_chunk = 0; int chunk_first = -1;)
+
+                #pragma omp for schedule(dynamic, 512) nowait // dynamic scheduling for load balance
+                for (int i = 0; i < (int)frontier.size(); ++i) { // for each node in frontier
+                    int u = frontier[i]; // current node
+                    BFS_TRC(if (i % kChunk == 0 && tr_on) { // a new chunk starts
+                                const double t = wall();
+                                if (chunk_first >= 0) tr.record(tid, "chunk", t_chunk, t, curr_level, chunk_first);
+                                t_chunk = t; chunk_first = i;
+                            })
+                    BFS_STAT(my.edges += g.degree(u);)
+                    for (int v : g[u]) { // explore neighbors
+                        // Atomic test-and-set: only first discoverer enqueues v
+                        uint8_t was = vis[v].exchange(1, memory_order_relaxed); // returns previous value 
+                        BFS_STAT(my.failed += was;)
+                        if (!was) {
+                            lvl[v] = curr_level + 1; // all writers would assign same value
+                            out.push_back(v); // enqueue into thread-local buffer
+                            next_edges += g.degree(v);
+                        }
+                    }
+                }
+                BFS_TRC(if (tr_on) {
+                            const double t_done = wall();
+                            if (chunk_first >= 0) tr.record(tid, "chunk", t_chunk, t_done, curr_level, chunk_first);
+                            _Pragma("omp barrier")
+                            tr.record(tid, "barrier", t_done, wall(), curr_level, 0);
+                        })
+                // The region's closing barrier ends the level; instrumented
+                // builds wait at an explicit one to time the imbalance.
+                BFS_STAT(const double t_done = wall(); my.busy_s = t_done - t_busy;
+                         _Pragma("omp barrier")
+                         my.wait_s = wall() - t_done; my.claims = my.edges - my.failed;
+                         L.per_thread[tid] = my;)
+            }
+            BFS_STAT(L.expand_s = wall() - t_level; const double t_merge = wall();)
+            BFS_TRC(const double t_mrg = wall();)
+
+            // Merge thread-local buffers into the next frontier
+            size_t total = 0; for (auto& v : tls) total += v.size();
+            next.reserve(total);
+            for (auto& v : tls) next.insert(next.end(), v.begin(), v.end());
+            size_t tls_bytes = 0; for (auto& v : tls) tls_bytes += bytes_of(v);
+            tls_peak = max(tls_peak, tls_bytes);
+            BFS_STAT(L.merge_s = wall() - t_merge;)
+            BFS_TRC(if (tr_on) tr.record(0, "merge", t_mrg, wall(), curr_level, (int64_t)total);)
+        }
+        BFS_TRC(if (tr_on) tr.record(0, "level", t_lvl, wall(), curr_level, (int64_t)frontier.size());)
+        BFS_STAT(stats.levels.push_back(std::move(L));)
+        if (perf_on) pc.levels.push_back(pc.read() - perf0);
+
+        frontier.swap(next);
+        frontier_edges = next_edges;
+        ++curr_level;
+    }
+
+    BFS_TRC(if (tr_on) tr.record(0, "bfs", t_bfs, wall(), curr_level, (int64_t)order.size());)
+    Footprint& fp = mem_footprint();
+    fp.add("visited", bytes_of(visited)); fp.add("level", bytes_of(level));
+    fp.add("order", bytes_of(order));
+    fp.add("frontier", bytes_of(frontier) + bytes_of(next) + tls_peak);
+    if (level_out) *level_out = std::move(level);
+    return order;
+}
+
+// Owner-computes level-synchronous BFS (no atomics in the hot path):
+// - Vertices are split into P contiguous blocks; thread t owns block t and is
+//   the only thread that ever writes visited/level of its vertices, so plain
+//   stores suffice. Each thread first-touches its own block.
+// - Each thread expands the frontier vertices it owns. A neighbor it owns is
+//   claimed directly; any other neighbor goes to outbox[t][owner].
+// - After a barrier every owner drains the outboxes addressed to it and claims
+//   the vertices it has not seen yet. Duplicates are filtered by the owner.
+// - The per-owner frontiers, concatenated in thread order, form each level.
+inline vector<int> bfs_openmp_owner(const Graph& g, int s, page_vector<int>* level_out = nullptr) {
+    const int n = (int)g.size();
+    int P = 1;
+    #ifdef _OPENMP
+    P = omp_get_max_threads();
+    #endif
+    const int block = (n + P - 1) / P;
+
+    page_vector<uint8_t> visited(n); // plain flags, written by the owner only
+    page_vector<int> level(n);
+    vector<int> order; order.reserve(n);
+
+    vector<page_vector<int>> cur(P), nxt(P);             // per-owner frontiers
+    vector<vector<page_vector<int>>> outbox(P, vector<page_vector<int>>(P));
+    vector<int64_t> cur_size(P, 0);
+
+    #pragma omp parallel num_threads(P)
+    {
+        int t = 0;
+        #ifdef _OPENMP
+        t = omp_get_thread_num();
+        #endif
+        const int lo = min(n, t * block), hi = min(n, lo + block);
+        for (int v = lo; v < hi; ++v) { visited[v] = 0; level[v] = -1; }
+        if (s >= lo && s < hi) { visited[s] = 1; level[s] = 0; cur[t].push_back(s); }
+        #pragma omp barrier
+
+        for (int curr_level = 0; ; ++curr_level) {
+            // record traversal order (implicit barrier at the end of single)
+            #pragma omp single
+            for (int p = 0; p < P; ++p) order.insert(order.end(), cur[p].begin(), cur[p].end());
+
+            // Expand own frontier: claim own vertices, route the rest to owners
+            auto& mine = nxt[t];
+            mine.clear();
+            for (int u : cur[t]) {
+                for (int v : g[u]) {
+                    int o = v / block;
+                    if (o == t) {
+                        if (!visited[v]) {
+                            visited[v] = 1;
+                            level[v] = curr_level + 1;
+                            mine.push_back(v);
+                        }
+                    } else {
+                        outbox[t][o].push_back(v);
+                    }
+                }
+            }
+            #pragma omp barrier
+
+            // Drain the outboxes addressed to this owner
+            for (int p = 0; p < P; ++p) {
+                auto& box = outbox[p][t];
+                for (int v : box) {
+                    if (!visited[v]) {
+                        visited[v] = 1;
+                        level[v] = curr_level + 1;
+                        mine.push_back(v);
+                    }
+                }
+                box.clear();
+            }
+            cur[t].swap(mine);
+            cur_size[t] = (int64_t)cur[t].size();
+            #pragma omp barrier
+
+            int64_t total = 0;
+            for (int p = 0; p < P; ++p) total += cur_size[p];
+            if (total == 0) break;
+        }
+    }
+
+    size_t buffers = 0;
+    for (int p = 0; p < P; ++p) {
+        buffers += bytes_of(cur[p]) + bytes_of(nxt[p]);
+        for (auto& box : outbox[p]) buffers += bytes_of(box);
+    }
+    Footprint& fp = mem_footprint();
+    fp.add("visited", bytes_of(visited)); fp.add("level", bytes_of(level));
+    fp.add("order", bytes_of(order)); fp.add("frontier", buffers);
+    if (level_out) *level_out = std::move(level);
+    return order;
+}
+
+// Level-synchronous BFS with one shared next-frontier array (no merge phase):
+// - Threads reserve kChunk slots (one 64-byte cache line of ints) at a time with
+//   a single fetch_add on the shared tail and fill them with plain stores.
+// - At the end of a level each thread pads the unused rest of its last chunk
+//   with -1, so the array holds at most P * (kChunk - 1) gaps; the next level
+//   simply skips them. Capacity n + P * kChunk therefore always suffices.
+// - Discovery uses the same atomic exchange on visited[v] as bfs_openmp_level.
+inline vector<int> bfs_openmp_chunked(const Graph& g, int s, page_vector<int>* level_out = nullptr) {
+    const int n = (int)g.size();
+    constexpr int kChunk = 64 / sizeof(int);
+    int P = 1;
+    #ifdef _OPENMP
+    P = omp_get_max_threads();
+    #endif
+
+    page_vector<atomic<uint8_t>> visited(n);
+    page_vector<int> level(n);
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < n; ++i) {
+        visited[i].store(0, memory_order_relaxed);
+        level[i] = -1;
+    }
+
+    const int64_t cap = (int64_t)n + (int64_t)P * kChunk;
+    page_vector<int> cur(cap), next(cap); // pages touched on first fill
+    vector<int> order; order.reserve(n);
+    atomic<int64_t> tail(0);
+
+    visited[s].store(1, memory_order_relaxed);
+    level[s] = 0;
+    cur[0] = s;
+    int64_t cur_len = 1;
+    int curr_level = 0;
+
+    while (cur_len > 0) {
+        // record traversal order, skipping padding
+        for (int64_t i = 0; i < cur_len; ++i)
+            if (cur[i] >= 0) order.push_back(cur[i]);
+
+        tail.store(0, memory_order_relaxed);
+        #pragma omp parallel
+        {
+            int64_t slot = 0, end = 0; // this thread's current chunk [slot, end)
+
+            #pragma omp for schedule(dynamic, 512)
+            for (int64_t i = 0; i < cur_len; ++i) {
+                int u = cur[i];
+                if (u < 0) continue; // padding from the previous level
+                for (int v : g[u]) {
+                    if (!visited[v].exchange(1, memory_order_relaxed)) {
+                        level[v] = curr_level + 1;
+                        if (slot == end) {
+                            slot = tail.fetch_add(kChunk, memory_order_relaxed);
+                            end = slot + kChunk;
+                        }
+                        next[slot++] = v;
+                    }
+                }
+            }
+            while (slot < end) next[slot++] = -1; // pad the partial chunk
+        }
+
+        cur.swap(next);
+        cur_len = tail.load(memory_order_relaxed);
+        ++curr_level;
+    }
+
+    Footprint& fp = mem_footprint();
+    fp.add("visited", bytes_of(visited)); fp.add("level", bytes_of(level));
+    fp.add("order", bytes_of(order)); fp.add("frontier", bytes_of(cur) + bytes_of(next));
+    if (level_out) *level_out = std::move(level);
+    return order;
+}
+
+// Scratch of bidir_bfs_distance(), reused across queries: only the vertices a
+// query touched are reset afterwards, so a query costs what it visits.
+struct BidirScratch {
+    vector<int> dist_s, dist_t;        // -1 = not seen from that side
+    vector<int> parent_s, parent_t;    // BFS tree of each side (valid where seen)
+    vector<int> front_s, front_t, next, touched;
+    int meet = -1;                     // a vertex on a shortest path, after a hit
+    explicit BidirScratch(int n) : dist_s(n, -1), dist_t(n, -1), parent_s(n), parent_t(n) {}
+};
+
+// Point-to-point distance by bidirectional BFS: expands one full level at a
+// time from the side whose frontier has fewer edges and stops at the first
+// level where the two searches meet. `rev` holds the reversed edges (g itself
+// when undirected). Returns -1 when t is unreachable.
+inline int bidir_bfs_distance(const Graph& g, const Graph& rev, int s, int t, BidirScratch& w) {
+    w.meet = s == t ? s : -1;
+    if (s == t) return 0;
+    w.front_s.assign(1, s); w.front_t.assign(1, t);
+    w.touched.clear(); w.touched.push_back(s); w.touched.push_back(t);
+    w.dist_s[s] = 0; w.dist_t[t] = 0;
+    w.parent_s[s] = s; w.parent_t[t] = t;
+    int ds = 0, dt = 0, best = -1;
+    while (best < 0 && !w.front_s.empty() && !w.front_t.empty()) {
+        int64_t es = 0, et = 0;
+        for (int v : w.front_s) es += g.degree(v);
+        for (int v : w.front_t) et += rev.degree(v);
+        const bool fwd = es <= et;
+        const Graph& G = fwd ? g : rev;
+        vector<int>& mine = fwd ? w.dist_s : w.dist_t;
+        vector<int>& parent = fwd ? w.parent_s : w.parent_t;
+        const vector<int>& other = fwd ? w.dist_t : w.dist_s;
+        vector<int>& front = fwd ? w.front_s : w.front_t;
+        const int d = (fwd ? ds : dt) + 1;
+        w.next.clear();
+        for (int u : front)
+            for (int v : G[u]) {
+                if (mine[v] >= 0) continue;
+                mine[v] = d;
+                parent[v] = u;
+                w.touched.push_back(v);
+                w.next.push_back(v);
+                if (other[v] >= 0 && (best < 0 || d + other[v] < best)) { best = d + other[v]; w.meet = v; }
+            }
+        front.swap(w.next);
+        (fwd ? ds : dt) = d;
+    }
+    for (int v : w.touched) { w.dist_s[v] = -1; w.dist_t[v] = -1; }
+    return best;
+}
+
+// A shortest path s -> t (s and t included) from the last bidir_bfs_distance
+// call; the parent arrays are not reset, so this works after it returned.
+inline void bidir_bfs_path(const BidirScratch& w, int s, int t, vector<int>& path) {
+    path.clear();
+    if (w.meet < 0) return;
+    for (int v = w.meet; ; v = w.parent_s[v]) { path.push_back(v); if (v == s) break; }
+    reverse(path.begin(), path.end());
+    for (int v = w.meet; v != t; ) { v = w.parent_t[v]; path.push_back(v); }
+}
+
+// Parallel engines selectable with --engine (default: the first entry).
+struct Engine {
+    const char* name;
+    vector<int> (*run)(const Graph&, int, page_vector<int>*);
+};
+static const Engine kEngines[] = {
+    { "level", bfs_openmp_level },  // shared atomic visited flags
+    { "owner", bfs_openmp_owner },  // owner-computes, atomic-free
+    { "chunked", bfs_openmp_chunked }, // shared queue, chunk reservation
+};
+
+inline const Engine* find_engine(const string& name) {
+    for (const Engine& e : kEngines)
+        if (name == e.name) return &e;
+    return nullptr;
+}
+
+// Graph500-style validation of one traversal (kernel 2 rules, on levels):
+// - the root has level 0;
+// - every edge u->v with u reached has v reached and level[v] <= level[u] + 1
+//   (undirected graphs store both directions, so |level[u] - level[v]| <= 1);
+// - every reached vertex other than the root has an in-neighbor one level up.
+template <class LevelVec>
+inline bool validate_bfs(const Graph& g, int root, const LevelVec& level) {
+    const int n = (int)g.size();
+    if (level[root] != 0) return false;
+    vector<uint8_t> has_parent(n, 0);
+    bool ok = true;
+    #pragma omp parallel for schedule(dynamic, 1024) reduction(&&:ok)
+    for (int u = 0; u < n; ++u) {
+        if (level[u] < 0) continue;
+        for (int v : g[u]) {
+            if (level[v] < 0 || level[v] > level[u] + 1) ok = false;
+            else if (level[v] == level[u] + 1) __atomic_store_n(&has_parent[v], 1, __ATOMIC_RELAXED);
+        }
+    }
+    for (int v = 0; v < n && ok; ++v)
+        if (v != root && level[v] >= 0 && !has_parent[v]) ok = false;
+    return ok;
+}
@@ -8,113 +8,953 @@
 #include <atomic>
 #include <iomanip>
 #include <fstream>     // needed for file input
+#include <cmath>
 #include "graph_utils.h"
+#include "mem_utils.h"
+#include "bfs_kernels.h"
+#include "graph_io.h"
+#include "ingest.h"
+#include "components.h"
+#include "betweenness.h"
+#include "closeness.h"
+#include "diameter.h"
+#include "pll.h"
+#include "landmarks.h"
+#include "scc.h"
+#include "reach.h"
+#include "query_server.h"
+#include "external_bfs.h"
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 using namespace std;
 
-// Reuse the sequential BFS to (1) compare times and (2) verify correctness by
-// comparing the level arrays (where nodes are reachable).
-static vector<int> bfs_seq(const Graph& g, int s, vector<int>* level_out = nullptr) {
-    const int n = (int)g.size();
-    vector<char> vis(n, 0);
-    vector<int> q;      q.reserve(n);
-    vector<int> order;  order.reserve(n);
-    vector<int> level(n, -1);
-
-    vis[s] = 1; level[s] = 0; q.push_back(s);
-    for (size_t h = 0; h < q.size(); ++h) {
-        int u = q[h];
-        order.push_back(u);
-        for (int v : g[u]) {
-            if (!vis[v]) {
-                vis[v] = 1;
-                level[v] = level[u] + 1;
-                q.push_back(v);
+// Thread placement: the OpenMP runtime reads OMP_PROC_BIND / OMP_PLACES before
+// main() runs, so they cannot be defaulted from here. On multi-socket machines
+// run with
+//     OMP_PROC_BIND=spread OMP_PLACES=cores ./bfs_par ...
+// so that the thread that first-touched a block of visited/level (static
+// schedule, see mem_utils.h) stays on the node holding it. main() prints a
+// hint when more than one NUMA node is online and threads are unbound.
+//
+// The BFS kernels and engines live in bfs_kernels.h (shared with bfs_bench).
+
+static const char* proc_bind_name() {
+    #ifdef _OPENMP
+    switch (omp_get_proc_bind()) {
+        case omp_proc_bind_false:  return "false";
+        case omp_proc_bind_true:   return "true";
+        case omp_proc_bind_close:  return "close";
+        case omp_proc_bind_spread: return "spread";
+        default:                   return "master";
+    }
+    #else
+    return "none";
+    #endif
+}
+
+// --numa-bench: every thread first-touches a private 32 MiB block, then streams
+// (1) its own block and (2) the block of the thread P/2 away, which lives on the
+// other socket under OMP_PROC_BIND=spread. Read bandwidth is summed per
+// (thread node, memory node) pair. Also samples where the pages of the CSR
+// neighbor array ended up, to check --interleave.
+static volatile uint64_t numa_sink;
+static void numa_bandwidth_bench(const Graph& g) {
+    int P = 1;
+    #ifdef _OPENMP
+    P = omp_get_max_threads();
+    #endif
+    const vector<int> nodes = numa_online_nodes();
+    const int N = *max_element(nodes.begin(), nodes.end()) + 1;
+    const size_t words = (size_t(32) << 20) / sizeof(uint64_t);
+    const int reps = 4;
+
+    page_vector<uint64_t> buf(words * P);
+    vector<int> cpu_node(P, 0), mem_node(P, 0);
+    vector<double> bw_local(N, 0.0), bw_shift(size_t(N) * N, 0.0);
+
+    #pragma omp parallel num_threads(P)
+    {
+        int t = 0;
+        #ifdef _OPENMP
+        t = omp_get_thread_num();
+        #endif
+        uint64_t* mine = buf.data() + t * words;
+        for (size_t i = 0; i < words; ++i) mine[i] = i; // first touch
+        cpu_node[t] = numa_current_node();
+        int pn = numa_page_node(mine);
+        mem_node[t] = pn >= 0 ? pn : cpu_node[t];
+
+        for (int pass = 0; pass < 2; ++pass) {
+            int src = pass == 0 ? t : (t + P / 2) % P;
+            const uint64_t* p = buf.data() + src * words;
+            #pragma omp barrier
+            double t0 = wall();
+            uint64_t sum = 0;
+            for (int r = 0; r < reps; ++r)
+                for (size_t i = 0; i < words; ++i) sum += p[i];
+            double gbps = reps * words * sizeof(uint64_t) / (wall() - t0) / 1e9;
+            #pragma omp critical
+            {
+                numa_sink = numa_sink + sum;
+                if (pass == 0) bw_local[cpu_node[t]] += gbps;
+                else bw_shift[size_t(cpu_node[t]) * N + mem_node[src]] += gbps;
             }
         }
     }
-    if (level_out) *level_out = std::move(level);
-    return order;
+
+    cout.setf(std::ios::fixed); cout << setprecision(3);
+    cout << "Numa_nodes=" << nodes.size() << "\n";
+    cout << "Threads=" << P << " Proc_bind=" << proc_bind_name() << "\n";
+    for (int nd : nodes) {
+        int cnt = (int)count(cpu_node.begin(), cpu_node.end(), nd);
+        if (cnt == 0) continue;
+        cout << "Node" << nd << "_threads=" << cnt
+             << " Local_GBps=" << bw_local[nd] << "\n";
+        for (int md : nodes)
+            if (bw_shift[size_t(nd) * N + md] > 0)
+                cout << "Node" << nd << "_from_node" << md
+                     << "_GBps=" << bw_shift[size_t(nd) * N + md] << "\n";
+    }
+
+    // Sample up to 4096 pages of the neighbor array
+    vector<int64_t> per_node(N, 0); int64_t unknown = 0;
+    const size_t bytes = g.adj.size() * sizeof(int);
+    const size_t page = 4096, pages = (bytes + page - 1) / page;
+    const size_t stride = max<size_t>(1, pages / 4096);
+    for (size_t pg = 0; pg < pages; pg += stride) {
+        int nd = numa_page_node((const char*)g.adj.data() + pg * page);
+        if (nd >= 0 && nd < N) per_node[nd]++; else unknown++;
+    }
+    cout << "Adj_pages_sampled:";
+    for (int nd : nodes) cout << " node" << nd << "=" << per_node[nd];
+    cout << " unknown=" << unknown << "\n";
+}
+
+// --hugepages: how many 2 MiB pages the large arrays actually received.
+static void print_huge_pages() {
+    HugePageReport r = huge_page_report();
+    cout << "Huge_pages_2MB=" << r.huge_bytes / kHugePage
+         << "/" << r.mapped_bytes / kHugePage
+         << " Hugetlb_pages_2MB=" << r.hugetlb_bytes / kHugePage << "\n";
+}
+
+
+// Edges traversed from a root, Graph500 style: input edges with an endpoint in
+// the reached set. Undirected edges are stored twice, so they count once.
+template <class LevelVec>
+static int64_t traversed_edges(const Graph& g, const LevelVec& level, bool directed) {
+    int64_t m = 0;
+    #pragma omp parallel for reduction(+:m)
+    for (int u = 0; u < g.size(); ++u)
+        if (level[u] >= 0) m += g.degree(u);
+    return directed ? m : m / 2;
+}
+
+// Summary of per-root TEPS values (Graph500 kernel 2 output: quartiles, and
+// the harmonic mean, which is the right mean for rates, with its stddev).
+struct TepsStats { double min, q1, median, q3, max, hmean, hstddev; };
+
+static TepsStats teps_stats(vector<double> x) {
+    sort(x.begin(), x.end());
+    const size_t k = x.size();
+    auto quantile = [&](double q) {
+        double pos = q * (k - 1);
+        size_t lo = (size_t)pos;
+        size_t hi = min(lo + 1, k - 1);
+        return x[lo] + (pos - lo) * (x[hi] - x[lo]);
+    };
+    double inv = 0;
+    for (double t : x) inv += 1.0 / t;
+    TepsStats st;
+    st.min = x.front(); st.max = x.back();
+    st.q1 = quantile(0.25); st.median = quantile(0.5); st.q3 = quantile(0.75);
+    st.hmean = k / inv;
+    double var = 0;
+    for (double t : x) var += (1.0 / t - 1.0 / st.hmean) * (1.0 / t - 1.0 / st.hmean);
+    st.hstddev = k > 1 ? sqrt(var / (k - 1)) * st.hmean * st.hmean / sqrt((double)k) : 0.0;
+    return st;
 }
 
-// Level-synchronous parallel BFS:
-// - 'frontier' contains current-level nodes.
-// - Threads expand neighbors of nodes in 'frontier' concurrently.
-// - 'visited[v].exchange(1)' returns previous value; only the first thread that
-//   flips from 0 to 1 enqueues v into its local buffer.
-// - After the parallel region, we merge all per-thread buffers to form next level.
-static vector<int> bfs_openmp_level(const Graph& g, int s, vector<int>* level_out = nullptr) {
+// --teps: Graph500 kernel 2 style benchmark. Samples distinct random roots with
+// non-zero degree, runs and validates the sequential and the parallel engine
+// from each root (same roots for both) and reports TEPS statistics.
+static int run_teps(const Graph& g, const Options& opt, const Engine& engine) {
     const int n = (int)g.size();
-    vector<atomic<uint8_t>> visited(n); // atomic visited flags 0 or 1
-    for (int i = 0; i < n; ++i) visited[i].store(0, memory_order_relaxed);
+    const bool directed = opt.directed && opt.file.empty();
 
-    vector<int> level(n, -1); // level of each node (-1 means unvisited)
-    vector<int> frontier; frontier.reserve(1024); // current level's frontier
-    vector<int> order;    order.reserve(n);   // order of visitation
+    vector<int> candidates;
+    for (int u = 0; u < n; ++u) if (g.degree(u) > 0) candidates.push_back(u);
+    if (candidates.empty()) { cerr << "No vertex with non-zero degree\n"; return 1; }
+    mt19937_64 rng(opt.seed);
+    shuffle(candidates.begin(), candidates.end(), rng);
+    if ((size_t)opt.roots > candidates.size())
+        cerr << "Note: only " << candidates.size() << " vertices have non-zero degree; --roots capped at "
+             << candidates.size() << "\n";
+    const vector<int> roots(candidates.begin(), candidates.begin() + min<size_t>(opt.roots, candidates.size()));
 
-    visited[s].store(1, memory_order_relaxed);
-    level[s] = 0; 
-    frontier.push_back(s);
-    int curr_level = 0;
+    vector<double> seq_teps, par_teps;
+    int valid = 0;
+    vector<int> lvl_seq;
+    page_vector<int> lvl_par;
+    for (int root : roots) {
+        double t0 = wall();
+        bfs_seq(g, root, &lvl_seq);
+        double t1 = wall();
+        engine.run(g, root, &lvl_par);
+        double t2 = wall();
 
-    while (!frontier.empty()) {
-        // record traversal order 
-        order.insert(order.end(), frontier.begin(), frontier.end());
+        bool ok = validate_bfs(g, root, lvl_seq) && validate_bfs(g, root, lvl_par);
+        valid += ok;
+        int64_t m = traversed_edges(g, lvl_seq, directed);
+        seq_teps.push_back(m / max(t1 - t0, 1e-9));
+        par_teps.push_back(m / max(t2 - t1, 1e-9));
+    }
 
-        // per-thread buffers to avoid pushing into a shared vector
-        int P = 1;
-        #ifdef _OPENMP
-        P = omp_get_max_threads();
-        #endif
-        vector<vector<int>> tls(P); // thread-local storage for next frontier
-        for (int t = 0; t < P; ++t) tls[t].reserve(frontier.size() / (P + 1) + 16); // heuristic estimate per thread 
-
-        // Parallel expansion of the current frontier
-        #pragma omp parallel
-        {
-            int tid = 0;
-            #ifdef _OPENMP
-            tid = omp_get_thread_num();
-            #endif
-            auto& out = tls[tid];
-
-            #pragma omp for schedule(dynamic, 512) // dynamic scheduling for load balance
-            for (int i = 0; i < (int)frontier.size(); ++i) { // for each node in frontier
-                int u = frontier[i]; // current node
-                for (int v : g[u]) { // explore neighbors
-                    // Atomic test-and-set: only first discoverer enqueues v
-                    uint8_t was = visited[v].exchange(1, memory_order_relaxed); // returns previous value 
-                    if (!was) {
-                        level[v] = curr_level + 1; // all writers would assign same value
-                        out.push_back(v); // enqueue into thread-local buffer
-                    }
-                }
-            }
+    auto print = [](const char* name, const TepsStats& st) {
+        cout << setprecision(6) << scientific
+             << name << "_TEPS_min=" << st.min << " "
+             << name << "_TEPS_q1=" << st.q1 << " "
+             << name << "_TEPS_median=" << st.median << " "
+             << name << "_TEPS_q3=" << st.q3 << " "
+             << name << "_TEPS_max=" << st.max << "\n"
+             << name << "_TEPS_hmean=" << st.hmean << " "
+             << name << "_TEPS_hstddev=" << st.hstddev << "\n";
+    };
+    cout << "Roots=" << roots.size() << "\n";
+    cout << "Engine=" << engine.name << "\n";
+    print("Seq", teps_stats(seq_teps));
+    print("Par", teps_stats(par_teps));
+    cout << "Validation=" << (valid == (int)roots.size() ? "OK" : "FAILED")
+         << " (" << valid << "/" << roots.size() << ")\n";
+    return valid == (int)roots.size() ? 0 : 1;
+}
+
+// One decimal ID per line (--cc-out, --scc-out).
+static bool write_ids(const string& path, const page_vector<int>& id) {
+    ofstream f(path, ios::binary);
+    if (!f) { cerr << "Failed to open " << path << "\n"; return false; }
+    vector<char> buf;
+    buf.reserve(id.size() * 11);
+    char tmp[16];
+    for (int c : id) {
+        char* e = put_uint(tmp, (uint32_t)c);
+        *e++ = '\n';
+        buf.insert(buf.end(), tmp, e);
+    }
+    f.write(buf.data(), (streamsize)buf.size());
+    return true;
+}
+
+// --cc: connected components with the chosen variant, checked against a
+// sequential BFS from --start (on undirected graphs its reached set must be
+// exactly the start's component; on directed graphs a subset of it).
+static int run_cc(const Graph& g, const Options& opt) {
+    const int n = g.size();
+    const bool directed = opt.directed && opt.file.empty();
+    const double t0 = wall();
+    Components cc = opt.cc == "bfs" ? cc_bfs(g) : cc_afforest(g, directed);
+    const double t1 = wall();
+    phase_timer().add("cc", t1 - t0, 0, g.num_edges());
+
+    vector<int> lvl;
+    bfs_seq(g, opt.start, &lvl);
+    bool ok = true;
+    for (int u = 0; u < n && ok; ++u) {
+        const bool same = cc.connected(opt.start, u);
+        if (lvl[u] >= 0 ? !same : (same && !directed)) ok = false;
+    }
+
+    cout.setf(std::ios::fixed); cout << setprecision(6);
+    cout << "Cc_algorithm=" << opt.cc << "\n";
+    cout << "Cc_time_s=" << (t1 - t0) << "\n";
+    cout << "Components=" << cc.count() << "\n";
+    cout << "Largest_component=" << cc.size[0] << " (" << setprecision(2)
+         << 100.0 * cc.size[0] / n << "%)\n";
+    cout << "Start_component=" << cc.id[opt.start]
+         << " Start_component_size=" << cc.size[cc.id[opt.start]] << "\n";
+    cout << "Cc_size_hist=";
+    const vector<int64_t> hist = cc.log2_histogram();
+    for (size_t k = 0; k < hist.size(); ++k) {
+        if (!hist[k]) continue;
+        const int64_t lo = int64_t(1) << k, hi = (int64_t(2) << k) - 1;
+        cout << lo;
+        if (hi > lo) cout << "-" << hi;
+        cout << ":" << hist[k] << " ";
+    }
+    cout << "\n";
+    cout << "Cc_check=" << (ok ? "OK" : "MISMATCH") << "\n";
+
+    if (!opt.cc_out.empty()) {
+        if (!write_ids(opt.cc_out, cc.id)) return 1;
+        cout << "Cc_out=" << opt.cc_out << "\n";
+    }
+    phase_timer().print(cout);
+    return ok ? 0 : 1;
+}
+
+// --scc: strongly connected components (trim + forward-backward + Tarjan, or
+// Tarjan alone), checked against serial Tarjan, plus the condensation DAG.
+static int run_scc(const Graph& g, const Options& opt) {
+    const int n = g.size();
+    const bool directed = opt.directed && opt.file.empty();
+    Graph gt;
+    if (directed) gt = transpose(g);
+    const Graph& rev = directed ? gt : g;
+
+    const double t0 = wall();
+    Sccs s = opt.scc == "fwbw" ? scc_fwbw(g, rev) : scc_tarjan_all(g);
+    const double t1 = wall();
+    phase_timer().add("scc", t1 - t0, 0, g.num_edges());
+
+    // Same partition as the reference, and IDs in topological order
+    bool ok = true;
+    if (opt.scc == "fwbw") {
+        const Sccs ref = scc_tarjan_all(g);
+        vector<int> map_to(s.count(), -1), map_from(ref.count(), -1);
+        ok = s.count() == ref.count();
+        for (int u = 0; u < n && ok; ++u) {
+            int& a = map_to[s.id[u]];
+            int& b = map_from[ref.id[u]];
+            if (a < 0 && b < 0) { a = ref.id[u]; b = s.id[u]; }
+            ok = a == ref.id[u] && b == s.id[u];
         }
+    }
+    for (int u = 0; u < n && ok; ++u)
+        for (int v : g[u]) if (s.id[u] > s.id[v]) { ok = false; break; }
+
+    cout.setf(std::ios::fixed); cout << setprecision(6);
+    cout << "Scc_algorithm=" << opt.scc << " Scc_graph=" << (directed ? "directed" : "undirected") << "\n";
+    cout << "Scc_time_s=" << (t1 - t0) << " Scc_trim_s=" << s.trim_s << " Scc_fwbw_s=" << s.fwbw_s
+         << " Scc_tarjan_s=" << s.tarjan_s << " Scc_dag_s=" << s.dag_s << "\n";
+    if (opt.scc == "fwbw")
+        cout << "Scc_trimmed=" << s.trimmed << " Scc_giant=" << s.giant
+             << " Scc_remainder=" << s.remainder << "\n";
+    cout << "Sccs=" << s.count() << "\n";
+    cout << "Largest_scc=" << s.size[s.largest] << " (" << setprecision(2)
+         << 100.0 * s.size[s.largest] / n << "%)\n";
+    cout << "Scc_dag_vertices=" << s.dag.size() << " Scc_dag_edges=" << s.dag.num_edges()
+         << " Scc_dag_depth=" << s.dag_depth() << "\n";
+    cout << "Scc_check=" << (ok ? "OK" : "MISMATCH") << "\n";
+
+    if (!opt.scc_out.empty()) {
+        if (!write_ids(opt.scc_out, s.id)) return 1;
+        cout << "Scc_out=" << opt.scc_out << "\n";
+    }
+    if (!opt.scc_dag_out.empty()) {
+        if (!export_graph(s.dag, opt.scc_dag_out, "el", true)) return 1;
+        cout << "Scc_dag_out=" << opt.scc_dag_out << "\n";
+    }
+    phase_timer().print(cout);
+    return ok ? 0 : 1;
+}
+
+// --bc: betweenness centrality, exact or from --bc-samples random sources,
+// with the batched engine checked against serial Brandes on the first sources.
+static int run_bc(const Graph& g, const Options& opt) {
+    const int n = g.size();
+    const bool directed = opt.directed && opt.file.empty();
+
+    vector<int> candidates;
+    for (int u = 0; u < n; ++u) if (g.degree(u) > 0) candidates.push_back(u);
+    if (candidates.empty()) { cerr << "No vertex with non-zero degree\n"; return 1; }
+    vector<int> sources = candidates;
+    const bool sampled = opt.bc_samples > 0 && opt.bc_samples < (int)candidates.size();
+    if (sampled) {
+        mt19937_64 rng(opt.seed);
+        shuffle(sources.begin(), sources.end(), rng);
+        sources.resize(opt.bc_samples);
+        sort(sources.begin(), sources.end());
+    }
 
-        // Merge thread-local buffers into the next frontier
-        size_t total = 0; for (auto& v : tls) total += v.size();
-        vector<int> next; next.reserve(total);
-        for (auto& v : tls) next.insert(next.end(), v.begin(), v.end());
+    Graph gt;
+    if (directed) gt = transpose(g);
+    const Graph& in = directed ? gt : g;
 
-        frontier.swap(next);
-        ++curr_level;
+    mem_footprint().clear();
+    const double t0 = wall();
+    vector<double> bc = betweenness(g, in, sources, directed, opt.bc_batch);
+    const double t1 = wall();
+    phase_timer().add("bc", t1 - t0, 0, g.num_edges() * (int64_t)sources.size());
+    if (sampled) {
+        const double scale = (double)candidates.size() / sources.size();
+        for (double& x : bc) x *= scale;
     }
 
-    if (level_out) *level_out = std::move(level);
-    return order;
+    // Same sources through both implementations
+    const vector<int> probe(sources.begin(), sources.begin() + min<size_t>(64, sources.size()));
+    const vector<double> want = betweenness_serial(g, probe, directed);
+    const vector<double> got = betweenness(g, in, probe, directed, opt.bc_batch);
+    double max_err = 0;
+    for (int u = 0; u < n; ++u)
+        max_err = max(max_err, fabs(got[u] - want[u]) / max(1.0, fabs(want[u])));
+
+    vector<int> order(n);
+    for (int u = 0; u < n; ++u) order[u] = u;
+    const int top = min(n, opt.topk);
+    partial_sort(order.begin(), order.begin() + top, order.end(), [&](int a, int b) {
+        return bc[a] != bc[b] ? bc[a] > bc[b] : a < b;
+    });
+
+    cout.setf(std::ios::fixed); cout << setprecision(6);
+    cout << "Bc_mode=" << (sampled ? "sampled" : "exact")
+         << " Bc_sources=" << sources.size() << " Bc_batch=" << opt.bc_batch << "\n";
+    cout << "Bc_time_s=" << (t1 - t0) << "\n";
+    cout << "Bc_sources_per_s=" << setprecision(1) << sources.size() / max(t1 - t0, 1e-9) << "\n";
+    cout << "Bc_top=";
+    for (int k = 0; k < top; ++k)
+        cout << order[k] << ":" << setprecision(2) << bc[order[k]] << (k + 1 < top ? "," : "");
+    cout << "\n";
+    cout << "Bc_check=" << (max_err < 1e-9 ? "OK" : "MISMATCH") << " Bc_check_sources=" << probe.size()
+         << " Bc_check_max_rel_err=" << scientific << setprecision(2) << max_err << fixed << "\n";
+    mem_footprint().print(cout, "bc");
+    phase_timer().print(cout);
+    return max_err < 1e-9 ? 0 : 1;
 }
 
-// Small wall-clock helper that uses omp_get_wtime() when available.
-static double wall() {
-    #ifdef _OPENMP
-    return omp_get_wtime();
-    #else
-    using clk = chrono::steady_clock; static auto t0 = clk::now();
-    return chrono::duration<double>(clk::now() - t0).count();
-    #endif
+// Closeness and harmonic centrality of u from a plain BFS (the reference for
+// the batched versions).
+static void centrality_ref(const Graph& g, int u, double& closeness, double& harmonic) {
+    vector<int> lvl;
+    bfs_seq(g, u, &lvl);
+    int64_t far = 0, r = 0;
+    harmonic = 0;
+    for (int v = 0; v < (int)g.size(); ++v)
+        if (lvl[v] > 0) { far += lvl[v]; r++; harmonic += 1.0 / lvl[v]; }
+    closeness = far > 0 ? ((double)r / max((int)g.size() - 1, 1)) * ((double)r / far) : 0.0;
+}
+
+// --closeness: exact closeness/harmonic centrality of every vertex, or with
+// --closeness-samples K the sampled top-k by harmonic centrality (closeness.h).
+static int run_closeness(const Graph& g, const Options& opt) {
+    const int n = g.size();
+    const bool directed = opt.directed && opt.file.empty();
+    const int top = min(n, opt.topk);
+    const int64_t kMaxExact = 16384;   // cap on exactly resolved candidates
+    bool ok = true;
+    auto check = [&](int u, double closeness, double harmonic) {
+        double c, h;
+        centrality_ref(g, u, c, h);
+        if (fabs(c - closeness) > 1e-9 * max(1.0, c) || fabs(h - harmonic) > 1e-9 * max(1.0, h)) ok = false;
+    };
+
+    Graph gt;
+    if (directed) gt = transpose(g);
+    Footprint fp;
+    mem_footprint().clear();
+    cout.setf(std::ios::fixed); cout << setprecision(6);
+    if (opt.closeness_samples == 0) {
+        vector<int> all(n);
+        for (int u = 0; u < n; ++u) all[u] = u;
+        const double t0 = wall();
+        const Centrality c = centrality_exact(g, directed ? gt : g, all);
+        const double t1 = wall();
+        phase_timer().add("closeness", t1 - t0, 0, g.num_edges() * (int64_t)n);
+        fp = mem_footprint();
+        for (int u = 0; u < min(n, 16); ++u) check(u, c.closeness[u], c.harmonic[u]);
+
+        vector<int> by_c(all), by_h(all);
+        auto top_of = [&](vector<int>& order, const vector<double>& x) {
+            partial_sort(order.begin(), order.begin() + top, order.end(), [&](int a, int b) {
+                return x[a] != x[b] ? x[a] > x[b] : a < b;
+            });
+        };
+        top_of(by_c, c.closeness);
+        top_of(by_h, c.harmonic);
+
+        cout << "Closeness_mode=exact Closeness_sources=" << n << "\n";
+        cout << "Closeness_time_s=" << (t1 - t0) << "\n";
+        cout << "Closeness_sources_per_s=" << setprecision(1) << n / max(t1 - t0, 1e-9) << "\n";
+        cout << "Closeness_top=";
+        for (int k = 0; k < top; ++k)
+            cout << by_c[k] << ":" << setprecision(6) << c.closeness[by_c[k]] << (k + 1 < top ? "," : "");
+        cout << "\nHarmonic_top=";
+        for (int k = 0; k < top; ++k)
+            cout << by_h[k] << ":" << setprecision(1) << c.harmonic[by_h[k]] << (k + 1 < top ? "," : "");
+        cout << "\n";
+
+        if (!opt.closeness_out.empty()) {
+            ofstream f(opt.closeness_out);
+            if (!f) { cerr << "Failed to open " << opt.closeness_out << "\n"; return 1; }
+            f << setprecision(9);
+            for (int u = 0; u < n; ++u) f << c.closeness[u] << " " << c.harmonic[u] << "\n";
+            cout << "Closeness_out=" << opt.closeness_out << "\n";
+        }
+    } else {
+        const double t0 = wall();
+        const TopK t = harmonic_topk(g, directed ? gt : g, top, opt.closeness_samples, opt.seed, kMaxExact);
+        const double t1 = wall();
+        phase_timer().add("closeness", t1 - t0, 0,
+                          g.num_edges() * (int64_t)(opt.closeness_samples + t.exact));
+        fp = mem_footprint();
+        for (int k = 0; k < min(top, 4); ++k) check(t.vertex[k], t.closeness[k], t.harmonic[k]);
+
+        cout << "Closeness_mode=sampled Closeness_samples=" << opt.closeness_samples
+             << " Closeness_delta=" << setprecision(2) << kClosenessDelta << "\n";
+        cout << "Harmonic_eps_median=" << setprecision(1) << t.eps_median
+             << " Harmonic_max_err_observed=" << t.max_err
+             << " Harmonic_bound_misses=" << t.bound_misses << "\n";
+        cout << "Closeness_candidates=" << t.candidates << " Closeness_exact=" << t.exact
+             << " Closeness_certified=" << (t.certified ? "yes" : "no") << "\n";
+        cout << "Closeness_time_s=" << setprecision(6) << (t1 - t0) << "\n";
+        cout << "Harmonic_top=";
+        for (int k = 0; k < top; ++k)
+            cout << t.vertex[k] << ":" << setprecision(1) << t.harmonic[k] << ":"
+                 << setprecision(6) << t.closeness[k] << (k + 1 < top ? "," : "");
+        cout << "\n";
+    }
+    cout << "Closeness_check=" << (ok ? "OK" : "MISMATCH") << "\n";
+    fp.print(cout, "closeness");
+    phase_timer().print(cout);
+    return ok ? 0 : 1;
+}
+
+// --diameter: diameter (and radius for tk) of the largest component, checked
+// by brute force on small components.
+static int run_diameter(const Graph& g_in, const Options& opt) {
+    const bool directed = opt.directed && opt.file.empty();
+    Graph sym;
+    if (directed) sym = symmetrize(g_in);
+    const Graph& g = directed ? sym : g_in;
+    const int n = g.size();
+
+    const double t0 = wall();
+    const EccResult r = opt.diameter == "ifub" ? diameter_ifub(g) : diameter_tk(g, !opt.ecc_out.empty());
+    const double t1 = wall();
+    phase_timer().add("diameter", t1 - t0, 0, g.num_edges() * r.bfs_runs);
+
+    // Brute force: every eccentricity of the component
+    const int64_t kCheckMax = 4096;
+    string check = "skipped";
+    if (r.component <= kCheckMax) {
+        vector<int> lvl;
+        bfs_seq(g, max_degree_vertex(g), &lvl);
+        int diam = 0, rad = INT_MAX;
+        bool ok = true;
+        for (int u = 0; u < n; ++u) {
+            if (lvl[u] < 0) continue;
+            vector<int> lu;
+            bfs_seq(g, u, &lu);
+            const int e = *max_element(lu.begin(), lu.end());
+            diam = max(diam, e); rad = min(rad, e);
+            if (!r.ecc.empty() && r.ecc[u] != e) ok = false;
+        }
+        ok = ok && diam == r.diameter && (r.radius < 0 || rad == r.radius);
+        check = ok ? "OK" : "MISMATCH";
+    }
+
+    cout.setf(std::ios::fixed); cout << setprecision(6);
+    cout << "Diameter_algorithm=" << opt.diameter
+         << " Diameter_graph=" << (directed ? "undirected_view" : "undirected")
+         << " Diameter_component=" << r.component << "\n";
+    cout << "Diameter=" << r.diameter;
+    if (r.diameter_hi != r.diameter) cout << " Diameter_upper=" << r.diameter_hi;
+    cout << " Diameter_pair=" << r.from << "," << r.to << "\n";
+    if (r.radius >= 0) {
+        cout << "Radius=" << r.radius;
+        if (r.radius_lo != r.radius) cout << " Radius_lower=" << r.radius_lo;
+        cout << " Center=" << r.center << "\n";
+    }
+    cout << "Diameter_bfs_runs=" << r.bfs_runs << "\n";
+    cout << "Diameter_time_s=" << (t1 - t0) << "\n";
+    cout << "Diameter_check=" << check << "\n";
+
+    if (!opt.ecc_out.empty()) {
+        ofstream f(opt.ecc_out);
+        if (!f) { cerr << "Failed to open " << opt.ecc_out << "\n"; return 1; }
+        for (int u = 0; u < n; ++u) f << r.ecc[u] << "\n";
+        cout << "Ecc_out=" << opt.ecc_out << "\n";
+    }
+    phase_timer().print(cout);
+    return check == "MISMATCH" ? 1 : 0;
+}
+
+// Mean, median and 99th percentile of per-query latencies, in microseconds.
+static void print_latency(const char* name, vector<double> s) {
+    sort(s.begin(), s.end());
+    double sum = 0;
+    for (double x : s) sum += x;
+    cout << setprecision(3) << name << "_us_mean=" << 1e6 * sum / s.size()
+         << " " << name << "_us_p50=" << 1e6 * s[s.size() / 2]
+         << " " << name << "_us_p99=" << 1e6 * s[min(s.size() - 1, s.size() * 99 / 100)] << "\n";
+}
+
+// --pll-build / --pll: build and save the distance index (or open an existing
+// one), then time random queries on the mmap'ed file against bidirectional BFS.
+static int run_pll(const Graph& g, const Options& opt) {
+    const int n = g.size();
+    const bool directed = opt.directed && opt.file.empty();
+    Graph gt;
+    if (directed) gt = transpose(g);
+    const Graph& rev = directed ? gt : g;
+    cout.setf(std::ios::fixed); cout << setprecision(6);
+
+    string path = opt.pll;
+    if (!opt.pll_build.empty()) {
+        path = opt.pll_build;
+        PllIndex ix;
+        const double t0 = wall();
+        if (!pll_build(g, rev, directed, ix)) return 1;
+        const double t1 = wall();
+        phase_timer().add("pll_build", t1 - t0, 0, g.num_edges());
+        const int64_t bytes = pll_save(ix, path);
+        if (bytes < 0) { cerr << "Failed to write " << path << "\n"; return 1; }
+        cout << "Pll_build_s=" << (t1 - t0) << " Pll_build_mem_bytes=" << ix.bytes()
+             << " Pll_file=" << path << "\n";
+    }
+
+    PllFile file;
+    if (!file.open(path)) { cerr << "Failed to open index " << path << "\n"; return 1; }
+    const PllView& ix = file.view();
+    if (ix.n != n || ix.directed != directed) { cerr << "Index does not match the graph\n"; return 1; }
+    cout << "Pll_entries=" << ix.entries() << " Pll_avg_label=" << setprecision(1)
+         << (double)(ix.entries() - (uint64_t)n * (directed ? 2 : 1)) / n / (directed ? 2 : 1)
+         << " Pll_index_bytes=" << file.bytes() << " Pll_mmap=" << (file.mapped() ? "yes" : "no")
+         << " Pll_merge=" <<
+#ifdef __AVX2__
+            "avx2"
+#else
+            "scalar"
+#endif
+         << "\n";
+
+    mt19937_64 rng(opt.seed);
+    uniform_int_distribution<int> pick(0, n - 1);
+    vector<pair<int, int>> pairs(opt.queries);
+    for (auto& p : pairs) p = {pick(rng), pick(rng)};
+
+    // Index queries, each timed, after one untimed pass that faults in the
+    // mapped pages so the latencies are those of a warm index
+    vector<int> got(pairs.size());
+    vector<double> t_pll(pairs.size()), t_bfs;
+    for (size_t i = 0; i < pairs.size(); ++i) got[i] = pll_query(ix, pairs[i].first, pairs[i].second);
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        const double t = wall();
+        got[i] = pll_query(ix, pairs[i].first, pairs[i].second);
+        t_pll[i] = wall() - t;
+    }
+
+    // Bidirectional BFS on a prefix of the same pairs
+    const size_t checked = min<size_t>(pairs.size(), 1000);
+    BidirScratch w(n);
+    bool ok = true;
+    int64_t reachable = 0;
+    for (size_t i = 0; i < checked; ++i) {
+        const double t = wall();
+        const int d = bidir_bfs_distance(g, rev, pairs[i].first, pairs[i].second, w);
+        t_bfs.push_back(wall() - t);
+        ok = ok && d == got[i];
+        reachable += d >= 0;
+    }
+
+    cout << "Queries=" << pairs.size() << " Checked=" << checked << " Reachable=" << reachable << "\n";
+    print_latency("Pll_query", t_pll);
+    print_latency("Bidir_bfs", t_bfs);
+    cout << "Pll_check=" << (ok ? "OK" : "MISMATCH") << "\n";
+    phase_timer().print(cout);
+    return ok ? 0 : 1;
+}
+
+// --reach-build / --reach: build and save the reachability index (or open an
+// existing one), then time random queries on the mmap'ed file, report how
+// they were answered, and check a prefix against bidirectional BFS.
+static int run_reach(const Graph& g, const Options& opt) {
+    const int n = g.size();
+    const bool directed = opt.directed && opt.file.empty();
+    Graph gt;
+    if (directed) gt = transpose(g);
+    const Graph& rev = directed ? gt : g;
+    cout.setf(std::ios::fixed); cout << setprecision(6);
+
+    string path = opt.reach;
+    if (!opt.reach_build.empty()) {
+        path = opt.reach_build;
+        ReachIndex ix;
+        const double t0 = wall();
+        reach_build(g, rev, opt.reach_labels, opt.seed, ix);
+        const double t1 = wall();
+        phase_timer().add("reach_build", t1 - t0, 0, g.num_edges());
+        const int64_t bytes = reach_save(ix, path);
+        if (bytes < 0) { cerr << "Failed to write " << path << "\n"; return 1; }
+        cout << "Reach_build_s=" << (t1 - t0) << " Reach_scc_s=" << ix.scc_s
+             << " Reach_label_s=" << ix.label_s << " Reach_build_mem_bytes=" << ix.bytes()
+             << " Reach_file=" << path << "\n";
+    }
+
+    ReachFile file;
+    if (!file.open(path)) { cerr << "Failed to open index " << path << "\n"; return 1; }
+    const ReachView& ix = file.view();
+    if (ix.n != n) { cerr << "Index does not match the graph\n"; return 1; }
+    cout << "Reach_components=" << ix.c << " Reach_dag_edges=" << ix.offsets[ix.c]
+         << " Reach_labels=" << ix.k << " Reach_index_bytes=" << file.bytes()
+         << " Reach_mmap=" << (file.mapped() ? "yes" : "no") << "\n";
+
+    mt19937_64 rng(opt.seed);
+    uniform_int_distribution<int> pick(0, n - 1);
+    vector<pair<int, int>> pairs(opt.queries);
+    for (auto& p : pairs) p = {pick(rng), pick(rng)};
+
+    // Queries, each timed, after one untimed warm-up pass
+    ReachScratch w(ix.c);
+    vector<uint8_t> got(pairs.size());
+    vector<double> t_reach(pairs.size()), t_bfs;
+    int64_t how_count[kReachHowCount] = {0};
+    for (size_t i = 0; i < pairs.size(); ++i) got[i] = reach_query(ix, pairs[i].first, pairs[i].second, w);
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        ReachHow how;
+        const double t = wall();
+        got[i] = reach_query(ix, pairs[i].first, pairs[i].second, w, &how);
+        t_reach[i] = wall() - t;
+        how_count[how]++;
+    }
+
+    const size_t checked = min<size_t>(pairs.size(), 1000);
+    BidirScratch bw(n);
+    bool ok = true;
+    int64_t reachable = 0;
+    for (size_t i = 0; i < checked; ++i) {
+        const double t = wall();
+        const bool r = bidir_bfs_distance(g, rev, pairs[i].first, pairs[i].second, bw) >= 0;
+        t_bfs.push_back(wall() - t);
+        ok = ok && r == (bool)got[i];
+        reachable += r;
+    }
+
+    const double q = (double)pairs.size();
+    const int64_t fallback = how_count[kReachFallbackYes] + how_count[kReachFallbackNo];
+    const int64_t negative_at_labels = how_count[kReachLabelCut] + how_count[kReachFallbackNo];
+    cout << "Queries=" << pairs.size() << " Checked=" << checked << " Reachable=" << reachable << "\n";
+    cout << setprecision(4);
+    for (int h = 0; h < kReachHowCount; ++h)
+        cout << (h ? " " : "") << "Reach_" << kReachHowNames[h] << "=" << how_count[h] / q;
+    cout << "\n";
+    cout << "Reach_fallback_rate=" << fallback / q << " Reach_label_false_positive="
+         << (negative_at_labels ? (double)how_count[kReachFallbackNo] / negative_at_labels : 0.0) << "\n";
+    print_latency("Reach_query", t_reach);
+    print_latency("Bidir_bfs", t_bfs);
+    cout << "Reach_check=" << (ok ? "OK" : "MISMATCH") << "\n";
+    phase_timer().print(cout);
+    return ok ? 0 : 1;
+}
+
+// --serve: answer queries on a Unix domain socket (or stdin) until shutdown,
+// from the graph in memory and the optional --pll / --reach index files.
+static int run_serve(const Graph& g, const Options& opt) {
+    const bool directed = opt.directed && opt.file.empty();
+    Graph gt;
+    if (directed) gt = transpose(g);
+    QueryEngine e;
+    e.g = &g; e.rev = directed ? &gt : &g; e.directed = directed;
+
+    PllFile pll;
+    ReachFile reach;
+    if (!opt.pll.empty()) {
+        if (!pll.open(opt.pll)) { cerr << "Failed to open index " << opt.pll << "\n"; return 1; }
+        if (pll.view().n != g.size() || pll.view().directed != directed) { cerr << "Index does not match the graph\n"; return 1; }
+        e.pll = &pll.view();
+    }
+    if (!opt.reach.empty()) {
+        if (!reach.open(opt.reach)) { cerr << "Failed to open index " << opt.reach << "\n"; return 1; }
+        if (reach.view().n != g.size()) { cerr << "Index does not match the graph\n"; return 1; }
+        e.reach = &reach.view();
+    }
+    unique_ptr<BfsCache> cache;
+    if (opt.cache_mb > 0) {
+        cache.reset(new BfsCache(g.size(), (size_t)opt.cache_mb << 20, opt.cache_admit));
+        e.cache = cache.get();
+    }
+
+    // Status goes to stderr when stdout carries the responses
+    const bool stdio = opt.serve == "-";
+    ostream& log = stdio ? cerr : cout;
+    int threads = opt.serve_threads;
+#ifdef _OPENMP
+    if (threads == 0) threads = omp_get_max_threads();
+#endif
+    threads = max(threads, 1);
+    log << "Serve=" << (stdio ? "stdio" : opt.serve) << " Serve_threads=" << (stdio ? 1 : threads)
+        << " Serve_pll=" << (e.pll ? 1 : 0) << " Serve_reach=" << (e.reach ? 1 : 0)
+        << " Serve_cache_mb=" << opt.cache_mb << endl;
+
+    ServerStats st;
+    const double t0 = wall();
+    if (stdio) {
+        serve_stream(e, cin, cout, st);
+    } else {
+#if defined(__unix__) || defined(__APPLE__)
+        if (!serve_socket(e, opt.serve, threads, st)) return 1;
+#else
+        cerr << "--serve needs POSIX sockets here; use --serve -\n";
+        return 1;
+#endif
+    }
+    const double t1 = wall();
+    phase_timer().add("serve", t1 - t0);
+
+    int64_t total = 0;
+    for (int i = 0; i < kOpCount; ++i) total += st.count[i];
+    log << fixed << setprecision(3) << "Serve_time_s=" << (t1 - t0) << " Serve_queries=" << total
+        << " Serve_errors=" << st.errors << "\n";
+    for (int i = 0; i < kOpCount; ++i)
+        if (st.count[i])
+            log << "Serve_" << kOpNames[i] << "=" << st.count[i] << " Serve_" << kOpNames[i]
+                << "_us_mean=" << 1e-3 * st.ns[i] / st.count[i] << "\n";
+    if (cache) {
+        const BfsCache::Stats cs = cache->stats();
+        log << "Cache_hits=" << cs.hits << " Cache_misses=" << cs.misses << " Cache_hit_rate=" << cs.hit_rate()
+            << " Cache_inserts=" << cs.inserts << " Cache_evictions=" << cs.evictions
+            << " Cache_rejected=" << cs.rejected << "\n";
+        log << "Cache_entries=" << cs.entries << " Cache_bytes=" << cs.bytes << " Cache_budget="
+            << cache->budget() << " Cache_shards=" << cache->shards() << "\n";
+    }
+    phase_timer().print(log);
+    return 0;
+}
+
+// --external: semi-external BFS over a binary CSR file that is never loaded;
+// with --external-check the file is loaded after all and bfs_seq must give
+// the same level for every vertex.
+static int run_external(const Options& opt) {
+    ExternalCsr g;
+    if (!g.open(opt.external)) { cerr << "Not a binary CSR file: " << opt.external << "\n"; return 1; }
+    const int n = g.size();
+    if (opt.start >= n) { cerr << "Invalid --start\n"; return 1; }
+    ExtBfsConfig c;
+    c.mem_cap = (size_t)opt.ext_mem_mb << 20;
+    c.io_threads = opt.io_threads;
+    c.cold = opt.ext_cold;
+
+    vector<int> level;                       // only kept for the check
+    if (opt.external_check) level.assign(n, -1);
+    vector<int64_t> per_level;
+    ExtBfsStats st;
+    const bool ok = ext_bfs(g, opt.start, c, st, [&](int l, const vector<int>& vs) {
+        per_level.push_back((int64_t)vs.size());
+        if (opt.external_check) for (int v : vs) level[v] = l;
+    });
+    if (!ok) return 1;
+    phase_timer().add("external_bfs", st.total_s, st.bytes, st.edges);
+
+    cout << fixed << setprecision(3);
+    cout << "Ext_file=" << opt.external << " Ext_n=" << n << " Ext_m=" << g.h.m
+         << " Ext_directed=" << ((g.h.flags & kCsrDirected) ? 1 : 0) << " Ext_start=" << opt.start << "\n";
+    cout << "Ext_levels=" << st.levels << " Ext_visited=" << st.visited << " Ext_edges=" << st.edges
+         << " Ext_time_s=" << st.total_s << "\n";
+    cout << "Ext_read_MB=" << st.bytes / 1048576.0 << " Ext_reads=" << st.reads
+         << " Ext_read_MBps=" << st.bytes / 1048576.0 / max(st.total_s, 1e-9)
+         << " Ext_io_wait_s=" << st.io_wait_s << " Ext_sort_s=" << st.sort_s << "\n";
+    cout << "Ext_mem_cap=" << c.mem_cap << " Ext_bitmap_bytes=" << st.bitmap_bytes
+         << " Ext_io_buffer_bytes=" << st.io_bytes << " Ext_ram_peak=" << st.ram_peak
+         << " Ext_over_cap=" << (st.over_cap ? 1 : 0) << " Peak_RSS_bytes=" << peak_rss_bytes() << "\n";
+    cout << "Ext_level_sizes=";
+    for (size_t l = 0; l < per_level.size(); ++l) cout << (l ? "," : "") << per_level[l];
+    cout << "\n";
+
+    bool same = true;
+    if (opt.external_check) {
+        Graph gm;
+        if (!load_csr_bin(opt.external, gm)) return 1;
+        vector<int> lvl_seq;
+        bfs_seq(gm, opt.start, &lvl_seq);
+        same = lvl_seq == level;
+        cout << "Ext_check=" << (same ? "OK" : "MISMATCH") << "\n";
+    }
+    phase_timer().print(cout);
+    return same ? 0 : 1;
+}
+
+// --landmarks K: build the landmark oracle, then time bound queries on random
+// pairs and compare the bounds with bidirectional BFS on the first 1000.
+static int run_landmarks(const Graph& g, const Options& opt) {
+    const int n = g.size();
+    const bool directed = opt.directed && opt.file.empty();
+    Graph gt;
+    if (directed) gt = transpose(g);
+    const Graph& rev = directed ? gt : g;
+    cout.setf(std::ios::fixed); cout << setprecision(6);
+
+    mem_footprint().clear();
+    LandmarkOracle o;
+    const double t0 = wall();
+    if (!lm_build(g, rev, directed, opt.landmarks, opt.landmark_select, opt.seed, o)) return 1;
+    const double t1 = wall();
+    mem_footprint().add("landmarks", o.bytes());
+    phase_timer().add("landmarks", t1 - t0, 0, g.num_edges() * o.k * (directed ? 2 : 1));
+    cout << "Lm_select=" << opt.landmark_select << " Lm_count=" << o.k << " Lm_build_s=" << (t1 - t0)
+         << " Lm_bytes=" << o.bytes() << " Lm_bytes_per_vertex=" << o.stride * (directed ? 2 : 1) << "\n";
+
+    mt19937_64 rng(opt.seed);
+    uniform_int_distribution<int> pick(0, n - 1);
+    vector<pair<int, int>> pairs(opt.queries);
+    for (auto& p : pairs) p = {pick(rng), pick(rng)};
+
+    // Bound queries, each timed, after one untimed warm-up pass
+    vector<LmBounds> got(pairs.size());
+    vector<double> t_lm(pairs.size()), t_bfs;
+    for (size_t i = 0; i < pairs.size(); ++i) got[i] = lm_bounds(o, pairs[i].first, pairs[i].second);
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        const double t = wall();
+        got[i] = lm_bounds(o, pairs[i].first, pairs[i].second);
+        t_lm[i] = wall() - t;
+    }
+
+    // Accuracy against exact distances on a prefix of the same pairs
+    const size_t checked = min<size_t>(pairs.size(), 1000);
+    BidirScratch w(n);
+    bool ok = true;
+    int64_t reachable = 0, exact_hi = 0, exact_lo = 0, within1 = 0, no_hi = 0, unreach = 0, proven = 0;
+    double err_hi = 0, err_lo = 0;
+    for (size_t i = 0; i < checked; ++i) {
+        const double t = wall();
+        const int d = bidir_bfs_distance(g, rev, pairs[i].first, pairs[i].second, w);
+        t_bfs.push_back(wall() - t);
+        const LmBounds& b = got[i];
+        if (d < 0) {
+            unreach++; proven += b.unreachable;
+            ok = ok && b.hi < 0;
+            continue;
+        }
+        reachable++;
+        ok = ok && !b.unreachable && b.lo <= d && (b.hi < 0 || b.hi >= d);
+        if (b.hi < 0) { no_hi++; continue; }
+        exact_hi += b.hi == d; exact_lo += b.lo == d; within1 += b.hi - d <= 1;
+        if (d > 0) { err_hi += (double)(b.hi - d) / d; err_lo += (double)(d - b.lo) / d; }
+    }
+
+    const int64_t bounded = max<int64_t>(1, reachable - no_hi);
+    cout << "Queries=" << pairs.size() << " Checked=" << checked << " Reachable=" << reachable << "\n";
+    cout << setprecision(4) << "Lm_upper_exact=" << (double)exact_hi / bounded
+         << " Lm_upper_within1=" << (double)within1 / bounded
+         << " Lm_upper_rel_err=" << err_hi / bounded
+         << " Lm_lower_exact=" << (double)exact_lo / bounded
+         << " Lm_lower_rel_err=" << err_lo / bounded
+         << " Lm_no_upper=" << no_hi << " Lm_unreachable_proven=" << proven << "/" << unreach << "\n";
+    print_latency("Lm_query", t_lm);
+    print_latency("Bidir_bfs", t_bfs);
+    cout << "Lm_check=" << (ok ? "OK" : "MISMATCH") << "\n";
+    mem_footprint().print(cout, "lm");
+    phase_timer().print(cout);
+    return ok ? 0 : 1;
+}
+
+// --perf: counter deltas (summed over OpenMP threads) for the graph load, each
+// BFS iteration, and each level of the last parallel run.
+static void print_perf(const PerfSample& load, const vector<PerfSample>& seq,
+                       const vector<PerfSample>& par, const vector<PerfSample>& levels) {
+    auto line = [](const string& phase, const PerfSample& p) {
+        cout << "Perf_phase=" << phase << " ";
+        p.print(cout);
+        cout << "\n";
+    };
+    PerfSample seq_total, par_total;
+    for (auto& p : seq) seq_total += p;
+    for (auto& p : par) par_total += p;
+    line("load", load);
+    line("seq_total", seq_total);
+    line("par_total", par_total);
+    for (size_t k = 0; k < seq.size(); ++k) line("seq_iter" + to_string(k), seq[k]);
+    for (size_t k = 0; k < par.size(); ++k) line("par_iter" + to_string(k), par[k]);
+    for (size_t k = 0; k < levels.size(); ++k) line("par_level" + to_string(k), levels[k]);
 }
 
 int main(int argc, char** argv) {
@@ -122,54 +962,165 @@ int main(int argc, char** argv) {
     cin.tie(nullptr);
 
     // Parse shared CLI options
-    int n, deg, start, iters; bool directed; string file; uint64_t seed;
-    if (!parse_args(argc, argv, n, deg, start, file, seed, iters,directed)) return 1;
+    Options opt;
+    if (!parse_args(argc, argv, opt)) return 1;
+    phase_timer(); // end-to-end clock starts here
+    const int n = opt.n, start = opt.start, iters = opt.iters;
 
+    #ifdef _OPENMP
+    if (numa_online_nodes().size() > 1 && omp_get_proc_bind() == omp_proc_bind_false)
+        cerr << "Note: threads are not pinned; set OMP_PROC_BIND=spread OMP_PLACES=cores\n";
+    #endif
+
+    mem_policy().hugepages = opt.hugepages;
+
+    // Hardware counters: one group per OpenMP thread, opened before the load
+    PerfCounters& pc = perf_counters();
+    if (opt.perf && !pc.open())
+        cerr << "Perf counters unavailable: " << pc.error() << "\n";
+    const bool perf_on = pc.available();
+    PerfSample perf_load = pc.read();
+
+    // The semi-external BFS never loads the graph
+    if (!opt.external.empty()) return run_external(opt);
 
     // Build or load graph once
     Graph g;
-    if (!file.empty()) {
-        ifstream fin(file);
-        if (!fin) { cerr << "Failed to open " << file << "\n"; return 1; }
-        g = load_edgelist(fin, n);
+    if (!opt.file.empty() && opt.ingest == "pipeline") {
+        IngestStats ist;
+        if (!load_edgelist_pipelined(opt.file, n, g, opt.io_threads, opt.interleave, &ist)) return 1;
+        print_ingest(cout, ist);
+    } else if (!opt.file.empty()) {
+        ifstream fin(opt.file);
+        if (!fin) { cerr << "Failed to open " << opt.file << "\n"; return 1; }
+        g = load_edgelist(fin, n, opt.interleave);
     } else {
-        g = make_synthetic_graph(n, deg, directed, seed);
+        g = make_synthetic_graph(n, opt.deg, opt.directed, opt.seed, opt.interleave);
     }
 
+    perf_load = pc.read() - perf_load;
+    const size_t rss_load = peak_rss_bytes();
+
+    // Optional export (--export <path> --format el|bin|dot)
+    if (!opt.export_path.empty() &&
+        !export_graph(g, opt.export_path, opt.export_format, opt.directed && opt.file.empty()))
+        return 1;
+
+    if (opt.numa_bench) { numa_bandwidth_bench(g); return 0; }
+
+    const Engine* engine = find_engine(opt.engine);
+    if (!engine) { cerr << "Unknown --engine " << opt.engine << "\n"; return 1; }
+
+    // Calibrate per-level parallelism once, outside the timed runs
+    if (opt.grain > 0) set_level_grain(opt.grain);
+    const int64_t grain = level_tuning().grain;
+
+    if (opt.teps) return run_teps(g, opt, *engine);
+    if (!opt.cc.empty()) return run_cc(g, opt);
+    if (!opt.scc.empty()) return run_scc(g, opt);
+    if (opt.bc) return run_bc(g, opt);
+    if (opt.closeness) return run_closeness(g, opt);
+    if (!opt.diameter.empty()) return run_diameter(g, opt);
+    if (!opt.serve.empty()) return run_serve(g, opt);
+    if (!opt.pll_build.empty() || !opt.pll.empty()) return run_pll(g, opt);
+    if (!opt.reach_build.empty() || !opt.reach.empty()) return run_reach(g, opt);
+    if (opt.landmarks > 0) return run_landmarks(g, opt);
+
     // Baseline sequential run (also used for correctness checking)
-    vector<int> lvl_seq, lvl_par;
+    vector<int> lvl_seq;
+    page_vector<int> lvl_par;
 
+    vector<PerfSample> perf_seq, perf_par; // per iteration (only with --perf)
+
+    Footprint fp_seq;
+    mem_footprint().clear();
     double t0 = wall();
     vector<int> seq_order;
     for (int k = 0; k < iters; ++k) {
+        PerfSample p0; if (perf_on) p0 = pc.read();
         seq_order = bfs_seq(g, start, &lvl_seq);
+        if (perf_on) perf_seq.push_back(pc.read() - p0);
     }
     double t1 = wall();
+    fp_seq = mem_footprint();
+    mem_footprint().clear();
+    phase_timer().add("bfs_seq", t1 - t0, 0, g.num_edges() * iters);
 
+    // Timeline of the parallel runs (level engine, -DBFS_TRACE builds)
     double t2 = wall();
+    #ifdef BFS_TRACE
+    int P = 1;
+    #ifdef _OPENMP
+    P = omp_get_max_threads();
+    #endif
+    if (!opt.trace.empty()) bfs_tracer().enable(P, t2);
+    #endif
     vector<int> par_order;
     for (int k = 0; k < iters; ++k) {
-        par_order = bfs_openmp_level(g, start, &lvl_par);
+        PerfSample p0; if (perf_on) p0 = pc.read();
+        par_order = engine->run(g, start, &lvl_par);
+        if (perf_on) perf_par.push_back(pc.read() - p0);
     }
     double t3 = wall();
+    phase_timer().add("bfs_par", t3 - t2, 0, g.num_edges() * iters);
 
 
     // Verify levels match where nodes are reachable in both runs.
+    const double t_val = wall();
     bool ok = true;
     for (int i = 0; i < n; ++i) {
         if (lvl_seq[i] != -1 && lvl_par[i] != -1 && lvl_seq[i] != lvl_par[i]) {
             ok = false; break;
         }
     }
+    phase_timer().add("validate", wall() - t_val);
 
     // metrics 
     cout.setf(std::ios::fixed); cout << setprecision(6);
     cout << "Seq_time_s=" << (t1 - t0) << "\n";
     cout << "Par_time_s=" << (t3 - t2) << "\n";
     cout << "Iters=" << iters << "\n";
+    cout << "Engine=" << engine->name << "\n";
+    if (engine->run == bfs_openmp_level)
+        cout << "Level_grain_edges=" << (grain == INT64_MAX ? -1 : grain) << "\n";
     cout << "Speedup="   << ((t3 - t2) > 0 ? (t1 - t0) / (t3 - t2) : 1.0) << "\n";
     cout << "Level_check=" << (ok ? "OK" : "MISMATCH") << "\n";
     cout << "Visited_seq=" << seq_order.size()
          << " Visited_par=" << par_order.size() << "\n";
+    fp_seq.print(cout, "seq");
+    mem_footprint().print(cout, "par");
+    print_memory(cout, g, rss_load, peak_rss_bytes());
+    phase_timer().print(cout);
+    if (opt.hugepages) print_huge_pages();
+    if (perf_on) print_perf(perf_load, perf_seq, perf_par, pc.levels);
+
+    // Per-level statistics of the last parallel run
+    if (!opt.stats.empty()) {
+        #ifdef BFS_INSTRUMENT
+        if (engine->run != bfs_openmp_level)
+            cerr << "--stats covers the level engine only\n";
+        ofstream fs(opt.stats);
+        if (!fs) { cerr << "Failed to open " << opt.stats << "\n"; return 1; }
+        if (opt.stats_format == "csv") bfs_stats().write_csv(fs);
+        else                           bfs_stats().write_json(fs);
+        cout << "Stats=" << opt.stats << "\n";
+        #else
+        cerr << "--stats needs a build with -DBFS_INSTRUMENT\n";
+        #endif
+    }
+
+    // Chrome trace of the parallel runs
+    if (!opt.trace.empty()) {
+        #ifdef BFS_TRACE
+        if (engine->run != bfs_openmp_level)
+            cerr << "--trace covers the level engine only\n";
+        ofstream ft(opt.trace);
+        if (!ft) { cerr << "Failed to open " << opt.trace << "\n"; return 1; }
+        bfs_tracer().write_json(ft);
+        cout << "Trace=" << opt.trace << " Trace_dropped_events=" << bfs_tracer().dropped() << "\n";
+        #else
+        cerr << "--trace needs a build with -DBFS_TRACE\n";
+        #endif
+    }
     return 0;
 }
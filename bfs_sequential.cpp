@@ -1,12 +1,13 @@
 // bfs_sequential.cpp
 // -----------------------------------------------------------------------------
 // Sequential BFS baseline.
-// - Uses an adjacency list (vector<vector<int>>) for simplicity and good cache
-//   locality compared to linked lists.
+// - Uses the CSR Graph from graph_utils.h (offsets + one neighbor array), the
+//   same layout the parallel version traverses.
 // - NO printing inside the BFS loop (I/O would dominate runtime).
 // - Returns an optional 'level' array to enable correctness checks against
 //   the parallel version.
 // - Prints total time and visited count for benchmarking.
+// - Writes the graph only when asked to (--export, see graph_io.h).
 // Complexity: O(V + E)
 // -----------------------------------------------------------------------------
 
@@ -21,6 +22,8 @@
 #include <iomanip>
 #include <fstream>     // needed for file input
 #include "graph_utils.h"
+#include "graph_io.h"
+#include "ingest.h"
 using namespace std;
 
 // Standard queue-based BFS. If level_out is provided, we fill each node's level
@@ -47,6 +50,10 @@ static vector<int> bfs_seq(const Graph& g, int s, vector<int>* level_out = nullp
         }
     }
 
+    Footprint& fp = mem_footprint(); // bytes of each array, see mem_utils.h
+    fp.add("visited", bytes_of(vis)); fp.add("level", bytes_of(level));
+    fp.add("order", bytes_of(order)); fp.add("frontier", bytes_of(q));
+
     if (level_out) *level_out = std::move(level); 
     return order;
 }
@@ -56,27 +63,32 @@ int main(int argc, char** argv) {
     cin.tie(nullptr);
 
     // Parse shared CLI options
-    int n, deg, start;bool directed; string file; uint64_t seed; int iters;
-    if (!parse_args(argc, argv, n, deg, start, file, seed, iters,directed)) return 1;
+    Options opt;
+    if (!parse_args(argc, argv, opt)) return 1;
+    phase_timer(); // end-to-end clock starts here
+    const int n = opt.n, start = opt.start, iters = opt.iters;
+
+    mem_policy().hugepages = opt.hugepages;
 
     // Build or load the graph once
     Graph g;
-    if (!file.empty()) {
-        ifstream fin(file);
-        if (!fin) { cerr << "Failed to open " << file << "\n"; return 1; }
-        g = load_edgelist(fin, n);
+    if (!opt.file.empty() && opt.ingest == "pipeline") {
+        IngestStats ist;
+        if (!load_edgelist_pipelined(opt.file, n, g, opt.io_threads, opt.interleave, &ist)) return 1;
+        print_ingest(cout, ist);
+    } else if (!opt.file.empty()) {
+        ifstream fin(opt.file);
+        if (!fin) { cerr << "Failed to open " << opt.file << "\n"; return 1; }
+        g = load_edgelist(fin, n, opt.interleave);
     } else {
-        g = make_synthetic_graph(n, deg, directed, seed);
+        g = make_synthetic_graph(n, opt.deg, opt.directed, opt.seed, opt.interleave);
     }
+    const size_t rss_load = peak_rss_bytes();
 
-    ofstream fout("edges.txt");
-    for (int u = 0; u < g.size(); u++) {
-    for (int v : g[u]) {
-        if (u < v)   // avoid duplicate edges in undirected graph
-            fout << u << " " << v << "\n";
-        }
-    }
-    fout.close();
+    // Optional export (--export <path> --format el|bin|dot)
+    if (!opt.export_path.empty() &&
+        !export_graph(g, opt.export_path, opt.export_format, opt.directed && opt.file.empty()))
+        return 1;
 
 
     // Time only the BFS computation
@@ -89,6 +101,8 @@ int main(int argc, char** argv) {
     }
 
     auto t1 = chrono::steady_clock::now();
+    phase_timer().add("bfs_seq", chrono::duration<double>(t1 - t0).count(), 0,
+                      g.num_edges() * iters);
 
 
     //metrics 
@@ -99,5 +113,14 @@ int main(int argc, char** argv) {
     cout << "Avg_time_s=" << (dt.count() / iters) << "\n";
     cout << "Visited_count=" << ord.size() << "\n";
     cout << "Start=" << start << " N=" << n << "\n";
+    mem_footprint().print(cout, "seq");
+    print_memory(cout, g, rss_load, peak_rss_bytes());
+    phase_timer().print(cout);
+    if (opt.hugepages) {
+        HugePageReport r = huge_page_report();
+        cout << "Huge_pages_2MB=" << r.huge_bytes / kHugePage
+             << "/" << r.mapped_bytes / kHugePage
+             << " Hugetlb_pages_2MB=" << r.hugetlb_bytes / kHugePage << "\n";
+    }
     return 0;
 }
@@ -0,0 +1,99 @@
+// bfs_stats.h
+// -----------------------------------------------------------------------------
+// Per-level instrumentation for bfs_openmp_level.
+// -----------------------------------------------------------------------------
+//
+// Compile-time removable: the counters and timers in the traversal are wrapped
+// in BFS_STAT(...), which expands to nothing unless the build defines
+// BFS_INSTRUMENT:
+//
+//   g++ -O3 -std=c++17 -fopenmp -DBFS_INSTRUMENT bfs_openmp.cpp -o bfs_par
+//   ./bfs_par --n 1157828 --start 1 --file com-youtube.ungraph.txt
+//             --stats levels.csv --stats-format csv
+//
+// For every level of the most recent traversal we keep the frontier size, the
+// number of threads used, the wall time of the expansion and of the merge, and
+// per thread: edges examined, successful claims (visited 0 -> 1), failed
+// atomics (exchange found the vertex already visited), busy time and the time
+// spent waiting at the end-of-level barrier. A hub-heavy level shows up as one
+// thread with a large busy time while the others wait at the barrier.
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <ostream>
+#include <iomanip>
+using namespace std;
+
+#ifdef BFS_INSTRUMENT
+#define BFS_STAT(...) __VA_ARGS__
+#else
+#define BFS_STAT(...)
+#endif
+
+// Counters of one thread within one level.
+struct ThreadLevelStats {
+    int64_t edges = 0;      // neighbors examined
+    int64_t claims = 0;     // vertices this thread discovered
+    int64_t failed = 0;     // exchanges that found visited == 1
+    double busy_s = 0;      // time spent expanding its share of the frontier
+    double wait_s = 0;      // time at the end-of-level barrier
+};
+
+struct LevelStats {
+    int level = 0;
+    int threads = 1;
+    int64_t frontier = 0;   // vertices in this level's frontier
+    double expand_s = 0;    // wall time of the expansion (incl. barrier)
+    double merge_s = 0;     // wall time of merging per-thread buffers
+    vector<ThreadLevelStats> per_thread;
+
+    int64_t edges() const  { int64_t s = 0; for (auto& t : per_thread) s += t.edges;  return s; }
+    int64_t claims() const { int64_t s = 0; for (auto& t : per_thread) s += t.claims; return s; }
+    int64_t failed() const { int64_t s = 0; for (auto& t : per_thread) s += t.failed; return s; }
+};
+
+// Levels of the most recent instrumented traversal.
+struct TraversalStats {
+    vector<LevelStats> levels;
+
+    // One row per (level, thread); level-wide columns repeat on each row.
+    void write_csv(ostream& out) const {
+        out << "level,threads,frontier,expand_s,merge_s,thread,edges,claims,failed,busy_s,barrier_wait_s\n";
+        out << setprecision(9);
+        for (const LevelStats& L : levels)
+            for (size_t t = 0; t < L.per_thread.size(); ++t) {
+                const ThreadLevelStats& T = L.per_thread[t];
+                out << L.level << ',' << L.threads << ',' << L.frontier << ','
+                    << L.expand_s << ',' << L.merge_s << ',' << t << ','
+                    << T.edges << ',' << T.claims << ',' << T.failed << ','
+                    << T.busy_s << ',' << T.wait_s << '\n';
+            }
+    }
+
+    void write_json(ostream& out) const {
+        auto arr = [&](const LevelStats& L, auto get) {
+            out << '[';
+            for (size_t t = 0; t < L.per_thread.size(); ++t)
+                out << (t ? "," : "") << get(L.per_thread[t]);
+            out << ']';
+        };
+        out << setprecision(9) << "{\"levels\":[\n";
+        for (size_t i = 0; i < levels.size(); ++i) {
+            const LevelStats& L = levels[i];
+            out << "  {\"level\":" << L.level << ",\"threads\":" << L.threads
+                << ",\"frontier\":" << L.frontier << ",\"edges\":" << L.edges()
+                << ",\"claims\":" << L.claims() << ",\"failed\":" << L.failed()
+                << ",\"expand_s\":" << L.expand_s << ",\"merge_s\":" << L.merge_s;
+            out << ",\"thread_edges\":";   arr(L, [](const ThreadLevelStats& T) { return T.edges; });
+            out << ",\"thread_busy_s\":";  arr(L, [](const ThreadLevelStats& T) { return T.busy_s; });
+            out << ",\"barrier_wait_s\":"; arr(L, [](const ThreadLevelStats& T) { return T.wait_s; });
+            out << '}' << (i + 1 < levels.size() ? "," : "") << '\n';
+        }
+        out << "]}\n";
+    }
+};
+
+inline TraversalStats& bfs_stats() { static TraversalStats s; return s; }
@@ -0,0 +1,114 @@
+// bfs_trace.h
+// -----------------------------------------------------------------------------
+// Per-thread timeline of bfs_openmp_level in Chrome trace-event JSON, viewable
+// in chrome://tracing or https://ui.perfetto.dev.
+// -----------------------------------------------------------------------------
+//
+// Opt-in twice: the hooks in the traversal are wrapped in BFS_TRC(...), which
+// expands to nothing unless the build defines BFS_TRACE, and a traced build
+// records only after bfs_tracer().enable() (bfs_par --trace <path>):
+//
+//   g++ -O3 -std=c++17 -fopenmp -DBFS_TRACE bfs_openmp.cpp -o bfs_par_trace
+//   ./bfs_par_trace --n 1157828 --start 1 --file com-youtube.ungraph.txt
+//                   --trace trace.json
+//
+// Compiled in but disabled, the cost is a bit test per frontier vertex and one
+// well-predicted branch per chunk of 512 vertices and per level.
+//
+// Events are "complete" events (begin timestamp + duration):
+//   bfs           one traversal, arg = vertices visited       (thread 0)
+//   level         one BFS level, arg = frontier size          (thread 0)
+//   chunk         one dynamic chunk of the frontier expanded by a thread,
+//                 arg = index of its first frontier vertex
+//   barrier       a thread waiting for the others at the end of a level
+//   merge         concatenating the per-thread buffers, arg = next frontier size
+//   serial_level  a level expanded on the serial fast path   (thread 0)
+//
+// Each OpenMP thread writes only its own ring buffer, so recording needs no
+// locks or atomics; the rings are read after the parallel regions have ended.
+// A full ring overwrites its oldest events, keeping the most recent traversals.
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <ostream>
+#include <iomanip>
+using namespace std;
+
+#ifdef BFS_TRACE
+#define BFS_TRC(...) __VA_ARGS__
+#else
+#define BFS_TRC(...)
+#endif
+
+static const size_t kTraceRingEvents = size_t(1) << 16; // per thread, power of two
+
+struct TraceEvent {
+    const char* name;
+    double t0, t1;     // wall() seconds
+    int level;
+    int64_t arg;       // chunk: first frontier index, level: frontier size, ...
+};
+
+// Single-writer ring; aligned so threads' heads never share a cache line.
+struct alignas(64) TraceRing {
+    vector<TraceEvent> buf;
+    uint64_t head = 0; // events written so far
+
+    void push(const TraceEvent& e) { buf[head & (buf.size() - 1)] = e; ++head; }
+    uint64_t dropped() const { return head > buf.size() ? head - buf.size() : 0; }
+};
+
+class Tracer {
+public:
+    // Allocate one ring per thread; recording starts now. t_origin is the time
+    // that becomes ts = 0 in the trace.
+    void enable(int threads, double t_origin) {
+        rings_.assign(threads, TraceRing());
+        for (TraceRing& r : rings_) r.buf.resize(kTraceRingEvents);
+        origin_ = t_origin;
+        enabled_ = true;
+    }
+    bool enabled() const { return enabled_; }
+
+    // Called by thread `tid` only (tid < threads given to enable()).
+    void record(int tid, const char* name, double t0, double t1, int level, int64_t arg) {
+        rings_[tid].push({name, t0, t1, level, arg});
+    }
+
+    uint64_t dropped() const {
+        uint64_t d = 0;
+        for (const TraceRing& r : rings_) d += r.dropped();
+        return d;
+    }
+
+    void write_json(ostream& out) const {
+        out << fixed << setprecision(3) << "{\"traceEvents\":[\n";
+        bool first = true;
+        for (size_t t = 0; t < rings_.size(); ++t) {
+            out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+                << t << ",\"args\":{\"name\":\"omp thread " << t << "\"}}";
+            first = false;
+        }
+        for (size_t t = 0; t < rings_.size(); ++t) {
+            const TraceRing& r = rings_[t];
+            const uint64_t cap = r.buf.size();
+            for (uint64_t k = r.head > cap ? r.head - cap : 0; k < r.head; ++k) {
+                const TraceEvent& e = r.buf[k & (cap - 1)];
+                out << ",\n{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << t
+                    << ",\"ts\":" << (e.t0 - origin_) * 1e6 << ",\"dur\":" << (e.t1 - e.t0) * 1e6
+                    << ",\"args\":{\"level\":" << e.level << ",\"arg\":" << e.arg << "}}";
+            }
+        }
+        out << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":" << dropped()
+            << "}}\n";
+    }
+
+private:
+    vector<TraceRing> rings_;
+    double origin_ = 0;
+    bool enabled_ = false;
+};
+
+inline Tracer& bfs_tracer() { static Tracer t; return t; }
@@ -0,0 +1,276 @@
+// closeness.h
+// -----------------------------------------------------------------------------
+// Closeness and harmonic centrality of every vertex (bfs_par --closeness), and
+// a sampled top-k approximation with error bounds (--closeness-samples K).
+// -----------------------------------------------------------------------------
+//
+// Definitions, with d(u, v) the BFS distance from u (out-edges when directed):
+//   harmonic(u)  = sum over v != u of 1 / d(u, v)      (unreachable v add 0)
+//   closeness(u) = (r / (n - 1)) * (r / sum of d(u, v) over reached v)
+// where r is the number of vertices u reaches (Wasserman-Faust closeness, which
+// equals the classic (n - 1) / farness on connected graphs and stays
+// meaningful on disconnected ones).
+//
+// Both need a BFS from every vertex. msbfs_batch() runs up to 64 of them at
+// once (bit-parallel multi-source BFS, Then et al., VLDB'15): bit b of the
+// per-vertex seen/visit/next masks stands for source b, so a vertex reached
+// by several sources at the same distance is expanded once. Batches run on
+// different threads, each with its own MsBfsScratch; a batch itself is serial,
+// so there are no atomics on the masks.
+//
+// Sampled top-k ranks by harmonic centrality, which is defined on directed and
+// disconnected graphs alike:
+//   1. k random sources s, BFS over the reversed edges gives d(v, s) for all v;
+//      est(v) = n / k * sum over samples of 1 / d(v, s)   (unbiased).
+//      Every term lies in [0, 1]; the empirical Bernstein bound (Maurer and
+//      Pontil, 2009) with the sample variance V(v), taken two-sided and with a
+//      union bound over the n vertices, gives, for all v at once with
+//      probability >= 1 - delta (kClosenessDelta), |est(v) - harmonic(v)| <=
+//      eps(v) with
+//        eps(v) = n * (sqrt(2 V(v) L / k) + 7 L / (3 (k - 1))), L = ln(4n / delta)
+//      The variance term makes it far tighter than Hoeffding's n sqrt(L / 2k)
+//      on graphs where most distances are alike.
+//   2. Any vertex of the true top-k has est + eps >= the k-th largest
+//      est - eps, so those candidates (at most max_exact of them, best
+//      estimates first) are computed exactly and ranked. When the cap cuts
+//      the candidate list the result is reported as not certified.
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include "graph_utils.h"
+#include "mem_utils.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+using namespace std;
+
+static const double kClosenessDelta = 0.05;   // failure probability of the bound
+static const size_t kMsBfsPullRatio = 8;
+
+// Per-thread state of msbfs_batch(); masks are all-zero between batches.
+struct MsBfsScratch {
+    page_vector<uint64_t> seen, visit, next;
+    vector<int> frontier, next_frontier, reached;
+
+    explicit MsBfsScratch(int n) : seen(n), visit(n), next(n) {
+        first_touch_fill(seen.data(), seen.size(), uint64_t(0));
+        first_touch_fill(visit.data(), visit.size(), uint64_t(0));
+        first_touch_fill(next.data(), next.size(), uint64_t(0));
+    }
+    size_t bytes() const { return bytes_of(seen) + bytes_of(visit) + bytes_of(next); }
+};
+
+// BFS from src[0 .. k), k <= 64, at once over g; `rev` holds the reversed
+// edges (g itself when undirected). Calls on_level(d, w, mask) for every vertex
+// w first reached at distance d >= 1 by the sources in `mask`.
+// Levels whose frontier holds more than 1/kMsBfsPullRatio of the vertices are
+// expanded bottom-up: every vertex not yet seen by all sources ORs the visit
+// masks of its in-neighbors and stops once it has every missing bit. With 64
+// sources most levels are that dense, and the pull avoids the scattered
+// read-modify-writes of next[] (about 4x faster on the synthetic graphs).
+template <class OnLevel>
+inline void msbfs_batch(const Graph& g, const Graph& rev, const int* src, int k, MsBfsScratch& s,
+                        OnLevel on_level) {
+    uint64_t* seen = s.seen.data(); uint64_t* visit = s.visit.data(); uint64_t* next = s.next.data();
+    const uint64_t all = k == 64 ? ~uint64_t(0) : (uint64_t(1) << k) - 1;
+    s.frontier.clear(); s.reached.clear();
+    for (int b = 0; b < k; ++b) {
+        if (!visit[src[b]]) s.frontier.push_back(src[b]);
+        visit[src[b]] |= uint64_t(1) << b;
+        seen[src[b]] |= uint64_t(1) << b;
+    }
+    s.reached = s.frontier;
+
+    for (int d = 1; !s.frontier.empty(); ++d) {
+        s.next_frontier.clear();
+        if (s.frontier.size() * kMsBfsPullRatio > (size_t)g.size()) {
+            for (int w = 0; w < (int)g.size(); ++w) {
+                const uint64_t want = all & ~seen[w];
+                if (!want) continue;
+                uint64_t acc = 0;
+                for (int v : rev[w]) { acc |= visit[v]; if ((acc & want) == want) break; }
+                if (acc & want) { next[w] = acc & want; s.next_frontier.push_back(w); }
+            }
+        } else {
+            for (int v : s.frontier) {
+                const uint64_t m = visit[v];
+                for (int w : g[v]) {
+                    const uint64_t nm = m & ~seen[w];
+                    if (!nm) continue;
+                    if (!next[w]) s.next_frontier.push_back(w);
+                    next[w] |= nm;
+                }
+            }
+        }
+        for (int v : s.frontier) visit[v] = 0;
+        for (int w : s.next_frontier) {
+            seen[w] |= next[w];
+            visit[w] = next[w];
+            next[w] = 0;
+            on_level(d, w, visit[w]);
+        }
+        s.reached.insert(s.reached.end(), s.next_frontier.begin(), s.next_frontier.end());
+        s.frontier.swap(s.next_frontier);
+    }
+    for (int v : s.frontier) visit[v] = 0;
+    for (int v : s.reached) seen[v] = 0;
+}
+
+struct Centrality {
+    vector<double> closeness;   // per source, in the order of `sources`
+    vector<double> harmonic;
+};
+
+// Exact closeness and harmonic centrality of `sources` (all vertices by
+// default), 64 sources per batch, batches spread over the threads.
+inline Centrality centrality_exact(const Graph& g, const Graph& rev, const vector<int>& sources) {
+    const int n = g.size();
+    const int64_t k = (int64_t)sources.size();
+    const int64_t batches = (k + 63) / 64;
+    Centrality c;
+    c.closeness.assign(k, 0.0);
+    c.harmonic.assign(k, 0.0);
+
+    #pragma omp parallel
+    {
+        MsBfsScratch s(n);
+        #pragma omp single
+        mem_footprint().add("msbfs_scratch", s.bytes());
+
+        #pragma omp for schedule(dynamic, 1)
+        for (int64_t bi = 0; bi < batches; ++bi) {
+            const int64_t b0 = bi * 64;
+            const int kb = (int)min<int64_t>(64, k - b0);
+            int64_t far[64] = {0}, cnt[64] = {0};
+            double harm[64] = {0};
+            msbfs_batch(g, rev, &sources[b0], kb, s, [&](int d, int, uint64_t m) {
+                const double inv = 1.0 / d;
+                while (m) {
+                    const int b = __builtin_ctzll(m); m &= m - 1;
+                    far[b] += d; cnt[b]++; harm[b] += inv;
+                }
+            });
+            for (int b = 0; b < kb; ++b) {
+                const double r = (double)cnt[b];
+                c.closeness[b0 + b] = far[b] > 0 ? (r / max(n - 1, 1)) * (r / far[b]) : 0.0;
+                c.harmonic[b0 + b] = harm[b];
+            }
+        }
+    }
+    return c;
+}
+
+struct HarmonicEstimate {
+    vector<double> est;         // n / k * sum of 1 / d(v, s)
+    vector<double> eps;         // per-vertex bound on |est - harmonic|
+};
+
+// Harmonic centrality estimate of every vertex from `samples`: the BFS runs
+// over `rev`, the reversed edges of g. See the header comment.
+inline HarmonicEstimate harmonic_sampled(const Graph& g, const Graph& rev, const vector<int>& samples,
+                                         double delta = kClosenessDelta) {
+    const int n = g.size();
+    const int64_t k = (int64_t)samples.size();
+    const int64_t batches = (k + 63) / 64;
+    HarmonicEstimate h;
+    h.est.assign(n, 0.0);
+    h.eps.assign(n, (double)n);
+    vector<double> sq(n, 0.0);
+    double* e = h.est.data(); double* q = sq.data();
+
+    #pragma omp parallel
+    {
+        MsBfsScratch s(n);
+        #pragma omp for schedule(dynamic, 1)
+        for (int64_t bi = 0; bi < batches; ++bi) {
+            const int64_t b0 = bi * 64;
+            const int kb = (int)min<int64_t>(64, k - b0);
+            msbfs_batch(rev, g, &samples[b0], kb, s, [&](int d, int w, uint64_t m) {
+                const double c = (double)__builtin_popcountll(m);
+                #pragma omp atomic
+                e[w] += c / d;
+                #pragma omp atomic
+                q[w] += c / ((double)d * d);
+            });
+        }
+    }
+    if (k < 2) return h;
+    // Empirical Bernstein on the terms 1 / d(v, s) in [0, 1], two-sided (both
+    // bounds certify the top-k), union bound over n
+    const double lg = log(4.0 * n / delta);
+    for (int v = 0; v < n; ++v) {
+        const double mean = e[v] / k;
+        const double var = max(0.0, (q[v] / k - mean * mean) * k / (k - 1));
+        h.est[v] = n * mean;
+        h.eps[v] = min(1.0, sqrt(2 * var * lg / k) + 7 * lg / (3.0 * (k - 1))) * n;
+    }
+    return h;
+}
+
+struct TopK {
+    vector<int> vertex;         // top-k by exact harmonic centrality
+    vector<double> harmonic, closeness;
+    int64_t candidates = 0;     // vertices whose upper bound reaches the k-th lower bound
+    int64_t exact = 0;          // of which computed exactly
+    double eps_median = 0;      // of the per-vertex bounds
+    double max_err = 0;         // largest |estimate - exact| among the exact ones
+    int64_t bound_misses = 0;   // exact values outside est +- eps (expected 0)
+    bool certified = false;     // all candidates computed exactly
+};
+
+// Sampled top-k by harmonic centrality: estimate, then resolve the candidates
+// exactly (at most max_exact of them, best estimates first).
+inline TopK harmonic_topk(const Graph& g, const Graph& rev, int topk, int64_t samples,
+                          uint64_t seed, int64_t max_exact) {
+    const int n = g.size();
+    TopK r;
+    mt19937_64 rng(seed);
+    uniform_int_distribution<int> pick(0, n - 1);
+    vector<int> smp(samples);
+    for (int& s : smp) s = pick(rng);
+    sort(smp.begin(), smp.end());
+
+    const HarmonicEstimate h = harmonic_sampled(g, rev, smp);
+    vector<double> eps(h.eps);
+    nth_element(eps.begin(), eps.begin() + n / 2, eps.end());
+    r.eps_median = eps[n / 2];
+
+    // Candidates: upper bound >= k-th largest lower bound
+    topk = min(topk, n);
+    vector<double> lower(n);
+    for (int v = 0; v < n; ++v) lower[v] = h.est[v] - h.eps[v];
+    nth_element(lower.begin(), lower.begin() + (topk - 1), lower.end(), greater<double>());
+    const double cut = lower[topk - 1];
+    vector<int> order;
+    for (int v = 0; v < n; ++v) if (h.est[v] + h.eps[v] >= cut) order.push_back(v);
+    sort(order.begin(), order.end(), [&](int a, int b) {
+        return h.est[a] != h.est[b] ? h.est[a] > h.est[b] : a < b;
+    });
+    r.candidates = (int64_t)order.size();
+    r.exact = min(r.candidates, max<int64_t>(max_exact, topk));
+    r.certified = r.exact == r.candidates;
+
+    vector<int> cand(order.begin(), order.begin() + r.exact);
+    const Centrality c = centrality_exact(g, rev, cand);
+    for (size_t i = 0; i < cand.size(); ++i) {
+        const double err = fabs(h.est[cand[i]] - c.harmonic[i]);
+        r.max_err = max(r.max_err, err);
+        r.bound_misses += err > h.eps[cand[i]];
+    }
+    vector<int> idx(cand.size());
+    for (size_t i = 0; i < idx.size(); ++i) idx[i] = (int)i;
+    sort(idx.begin(), idx.end(), [&](int a, int b) {
+        return c.harmonic[a] != c.harmonic[b] ? c.harmonic[a] > c.harmonic[b] : cand[a] < cand[b];
+    });
+    for (int i = 0; i < topk; ++i) {
+        r.vertex.push_back(cand[idx[i]]);
+        r.harmonic.push_back(c.harmonic[idx[i]]);
+        r.closeness.push_back(c.closeness[idx[i]]);
+    }
+    return r;
+}
@@ -0,0 +1,176 @@
+// components.h
+// -----------------------------------------------------------------------------
+// Parallel connected components (of the undirected view of the graph; weakly
+// connected components for directed graphs). Used by bfs_par --cc.
+// -----------------------------------------------------------------------------
+//
+// Two variants, both ending in a union-find forest over comp[] that is linked
+// with lock-free CAS hooks (Shiloach-Vishkin style: the larger root is hooked
+// under the smaller one) and then fully compressed:
+//
+//   bfs       One bfs_openmp_level run from the highest-degree vertex labels
+//             the giant component with the level engine's frontier machinery;
+//             only the vertices it did not reach are then linked edge by edge.
+//   afforest  Afforest (Sutton et al., IPDPS'18): link the first two neighbors
+//             of every vertex, compress, find the dominant component by
+//             sampling, and link the remaining edges only for vertices outside
+//             it. On undirected graphs that skips most of the giant's edges.
+//
+// The result is a Components object: dense IDs ordered by size (0 = largest),
+// sizes, and an O(1) connected(u, v). A BFS from s can never reach t when
+// connected(s, t) is false, so callers can answer "unreachable" without
+// traversing.
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <string>
+#include <atomic>
+#include <algorithm>
+#include <random>
+#include <cstdint>
+#include "graph_utils.h"
+#include "mem_utils.h"
+#include "bfs_kernels.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+using namespace std;
+
+struct Components {
+    page_vector<int> id;        // dense component ID per vertex, 0 = largest
+    vector<int64_t> size;       // vertices per component, non-increasing
+
+    int count() const { return (int)size.size(); }
+    bool connected(int u, int v) const { return id[u] == id[v]; }
+
+    // Number of components per size bucket [2^k, 2^(k+1)), k = 0, 1, ...
+    vector<int64_t> log2_histogram() const {
+        vector<int64_t> h;
+        for (int64_t s : size) {
+            int k = 0;
+            while ((int64_t(2) << k) <= s) ++k;
+            if ((int)h.size() <= k) h.resize(k + 1, 0);
+            h[k]++;
+        }
+        return h;
+    }
+};
+
+// Hook the trees of u and v together (smaller root wins).
+inline void cc_link(atomic<int>* comp, int u, int v) {
+    int p1 = comp[u].load(memory_order_relaxed);
+    int p2 = comp[v].load(memory_order_relaxed);
+    while (p1 != p2) {
+        int high = max(p1, p2), low = min(p1, p2);
+        int p_high = comp[high].load(memory_order_relaxed);
+        if (p_high == low) break;
+        if (p_high == high &&
+            comp[high].compare_exchange_strong(p_high, low, memory_order_relaxed))
+            break;
+        p1 = comp[comp[high].load(memory_order_relaxed)].load(memory_order_relaxed);
+        p2 = comp[low].load(memory_order_relaxed);
+    }
+}
+
+// Point every vertex directly at its root.
+inline void cc_compress(atomic<int>* comp, int n) {
+    #pragma omp parallel for schedule(dynamic, 16384)
+    for (int u = 0; u < n; ++u) {
+        int c = comp[u].load(memory_order_relaxed);
+        while (c != comp[c].load(memory_order_relaxed)) c = comp[c].load(memory_order_relaxed);
+        comp[u].store(c, memory_order_relaxed);
+    }
+}
+
+// Most frequent root among `samples` random vertices.
+inline int cc_sample_frequent(const atomic<int>* comp, int n, int samples = 1024) {
+    mt19937 rng(27491095);
+    uniform_int_distribution<int> dist(0, n - 1);
+    vector<int> seen(samples);
+    for (int& c : seen) c = comp[dist(rng)].load(memory_order_relaxed);
+    sort(seen.begin(), seen.end());
+    int best = seen[0], best_cnt = 0;
+    for (size_t i = 0; i < seen.size(); ) {
+        size_t j = i;
+        while (j < seen.size() && seen[j] == seen[i]) ++j;
+        if ((int)(j - i) > best_cnt) { best_cnt = (int)(j - i); best = seen[i]; }
+        i = j;
+    }
+    return best;
+}
+
+// Roots -> dense IDs ordered by component size (ties by root).
+inline Components cc_finish(const atomic<int>* comp, int n) {
+    vector<int64_t> count(n, 0);
+    for (int u = 0; u < n; ++u) count[comp[u].load(memory_order_relaxed)]++;
+    vector<int> roots;
+    for (int u = 0; u < n; ++u) if (count[u]) roots.push_back(u);
+    sort(roots.begin(), roots.end(), [&](int a, int b) {
+        return count[a] != count[b] ? count[a] > count[b] : a < b;
+    });
+    vector<int> dense(n, -1);
+    Components cc;
+    for (size_t k = 0; k < roots.size(); ++k) {
+        dense[roots[k]] = (int)k;
+        cc.size.push_back(count[roots[k]]);
+    }
+    cc.id.resize(n);
+    #pragma omp parallel for schedule(static)
+    for (int u = 0; u < n; ++u) cc.id[u] = dense[comp[u].load(memory_order_relaxed)];
+    return cc;
+}
+
+// Afforest. `directed` graphs store each edge once, so the final phase cannot
+// skip the dominant component there (its in-edges would be lost).
+inline Components cc_afforest(const Graph& g, bool directed, int neighbor_rounds = 2) {
+    const int n = g.size();
+    page_vector<atomic<int>> comp_v(n);
+    atomic<int>* comp = comp_v.data();
+    #pragma omp parallel for schedule(static)
+    for (int u = 0; u < n; ++u) comp[u].store(u, memory_order_relaxed);
+
+    // Sparse sampling: the first few neighbors of every vertex
+    for (int r = 0; r < neighbor_rounds; ++r) {
+        #pragma omp parallel for schedule(dynamic, 16384)
+        for (int u = 0; u < n; ++u)
+            if (r < g.degree(u)) cc_link(comp, u, g[u][r]);
+        cc_compress(comp, n);
+    }
+
+    // Finish the remaining edges outside the dominant component
+    const int c = n > 0 ? cc_sample_frequent(comp, n) : 0;
+    #pragma omp parallel for schedule(dynamic, 4096)
+    for (int u = 0; u < n; ++u) {
+        if (!directed && comp[u].load(memory_order_relaxed) == c) continue;
+        AdjSpan nb = g[u];
+        for (size_t i = neighbor_rounds; i < nb.size(); ++i) cc_link(comp, u, nb[i]);
+    }
+    cc_compress(comp, n);
+    return cc_finish(comp, n);
+}
+
+// BFS for the giant component, union-find for the rest. Every out-neighbor of
+// a reached vertex is reached, so linking the edges of the unreached vertices
+// covers all remaining connections, for directed graphs too.
+inline Components cc_bfs(const Graph& g) {
+    const int n = g.size();
+    int root = 0;
+    for (int u = 1; u < n; ++u) if (g.degree(u) > g.degree(root)) root = u;
+
+    page_vector<int> level;
+    bfs_openmp_level(g, root, &level);
+
+    page_vector<atomic<int>> comp_v(n);
+    atomic<int>* comp = comp_v.data();
+    #pragma omp parallel for schedule(static)
+    for (int u = 0; u < n; ++u) comp[u].store(level[u] >= 0 ? root : u, memory_order_relaxed);
+
+    #pragma omp parallel for schedule(dynamic, 4096)
+    for (int u = 0; u < n; ++u) {
+        if (level[u] >= 0) continue;
+        for (int v : g[u]) cc_link(comp, u, v);
+    }
+    cc_compress(comp, n);
+    return cc_finish(comp, n);
+}
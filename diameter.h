@@ -0,0 +1,190 @@
+// diameter.h
+// -----------------------------------------------------------------------------
+// Exact diameter, radius and eccentricities without a BFS from every vertex.
+// Used by bfs_par --diameter ifub|tk [--ecc-out path].
+// -----------------------------------------------------------------------------
+//
+// Both algorithms work on the connected component of the highest-degree
+// vertex (the giant component in practice) of an undirected graph; directed
+// graphs are passed in as their undirected view (symmetrize()). Every BFS is
+// a bfs_openmp_level run, and its level array - d(v, w) for all w - plus its
+// level count ecc(v) feed the bounds.
+//
+//   ifub  iFUB (Crescenzi et al., TCS 2013). A 4-sweep picks a central vertex
+//         u and a lower bound lb; the BFS from u splits the component into
+//         fringe levels F_i. Any two vertices at levels <= i - 1 are within
+//         2(i - 1) of each other, so the eccentricities of F_ecc(u), F_ecc(u)-1,
+//         ... are computed until lb > 2(i - 1) after a whole level (or lb
+//         reaches 2i within F_i, which no pair at level <= i exceeds).
+//         Diameter only.
+//   tk    Takes-Kosters BoundingDiameters (TCS 2013). Every vertex keeps
+//         bounds lo <= ecc <= hi; a BFS from v with ecc e tightens them to
+//           lo(w) >= max(e - d(v, w), d(v, w)),  hi(w) <= e + d(v, w).
+//         Sources alternate between the largest hi and the smallest lo (ties
+//         to the higher degree) among the vertices whose bounds still straddle
+//         the diameter or radius bounds; when none is left both are exact.
+//         With all = true it runs until every vertex's eccentricity is exact
+//         (--ecc-out).
+//
+// Both typically need tens of BFS runs on small-world graphs; bfs_runs counts
+// them, including the initial BFS that finds the component.
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include "graph_utils.h"
+#include "mem_utils.h"
+#include "bfs_kernels.h"
+using namespace std;
+
+struct EccResult {
+    int diameter = 0;          // exact when diameter_lo == diameter_hi
+    int diameter_hi = 0;
+    int radius = -1;           // tk only; -1 when not computed
+    int radius_lo = -1;
+    int from = -1, to = -1;    // a diametral pair
+    int center = -1;           // tk: a vertex of eccentricity radius
+    int64_t component = 0;     // vertices in the component
+    int64_t bfs_runs = 0;
+    page_vector<int> ecc;      // tk with all: eccentricity per vertex, -1 outside
+};
+
+// One parallel BFS from s; returns ecc(s) and the farthest vertex in *far.
+inline int ecc_bfs(const Graph& g, int s, page_vector<int>& level, int* far, EccResult& r) {
+    const vector<int> order = bfs_openmp_level(g, s, &level);
+    r.bfs_runs++;
+    *far = order.back();
+    return level[order.back()];
+}
+
+// Vertex at distance d from `a` on a shortest path from `a` to `b`, walking
+// back from b through `level` (the levels of a BFS from a).
+inline int path_vertex(const Graph& g, const page_vector<int>& level, int b, int d) {
+    int v = b;
+    while (level[v] > d)
+        for (int w : g[v])
+            if (level[w] == level[v] - 1) { v = w; break; }
+    return v;
+}
+
+inline int max_degree_vertex(const Graph& g) {
+    int root = 0;
+    for (int u = 1; u < g.size(); ++u) if (g.degree(u) > g.degree(root)) root = u;
+    return root;
+}
+
+// iFUB with a 4-sweep start.
+inline EccResult diameter_ifub(const Graph& g) {
+    EccResult r;
+    page_vector<int> level;
+    int a, b;
+    const int r1 = max_degree_vertex(g);
+
+    // 4-sweep: r1 -> a1 -> b1, u1 = middle of a1..b1, u1 -> a2 -> b2, u = middle
+    ecc_bfs(g, r1, level, &a, r);
+    for (int v : level) r.component += v >= 0;
+    int lb = ecc_bfs(g, a, level, &b, r);
+    r.from = a; r.to = b;
+    const int r2 = path_vertex(g, level, b, lb / 2);
+    ecc_bfs(g, r2, level, &a, r);
+    const int e2 = ecc_bfs(g, a, level, &b, r);
+    if (e2 > lb) { lb = e2; r.from = a; r.to = b; }
+    const int u = path_vertex(g, level, b, e2 / 2);
+
+    // Fringe levels of u, outermost first
+    const int eu = ecc_bfs(g, u, level, &b, r);
+    if (eu > lb) { lb = eu; r.from = u; r.to = b; }
+    vector<vector<int>> fringe(eu + 1);
+    for (int v = 0; v < g.size(); ++v) if (level[v] >= 0) fringe[level[v]].push_back(v);
+
+    int ub = 2 * eu;
+    page_vector<int> lv;
+    for (int i = eu; i > 0 && lb < ub; --i) {
+        for (int v : fringe[i]) {
+            const int e = ecc_bfs(g, v, lv, &b, r);
+            if (e > lb) { lb = e; r.from = v; r.to = b; }
+            if (lb >= 2 * i) break;        // two vertices of F_i are at most 2i apart
+        }
+        ub = max(lb, 2 * (i - 1));         // F_i done: what is left is within 2(i - 1)
+    }
+    r.diameter = r.diameter_hi = lb;   // every fringe level was bounded or done
+    return r;
+}
+
+// Takes-Kosters BoundingDiameters; `all` continues until every eccentricity
+// in the component is exact.
+inline EccResult diameter_tk(const Graph& g, bool all = false) {
+    const int n = g.size();
+    EccResult r;
+    page_vector<int> level;
+    int far;
+    const int root = max_degree_vertex(g);
+
+    // The first BFS finds the component and already bounds everything in it
+    vector<int> cand;                  // W: vertices whose bounds still matter
+    vector<int> lo(n, 0), hi(n, INT_MAX);
+    vector<uint8_t> exact(n, 0);
+    int d_lo = 0, d_hi = INT_MAX, r_lo = 0, r_hi = INT_MAX;
+    int v = root;
+    bool pick_high = true;
+    for (;;) {
+        const int e = ecc_bfs(g, v, level, &far, r);
+        if (r.bfs_runs == 1)
+            for (int w = 0; w < n; ++w) if (level[w] >= 0) { cand.push_back(w); r.component++; }
+        if (e > d_lo) { d_lo = e; r.from = v; r.to = far; }
+        if (e < r_hi) { r_hi = e; r.center = v; }
+        lo[v] = hi[v] = e;
+
+        // Tighten every vertex of the component, then the global bounds
+        d_hi = 0; r_lo = INT_MAX;
+        for (int w = 0; w < n; ++w) {
+            const int d = level[w];
+            if (d < 0) continue;
+            lo[w] = max(lo[w], max(e - d, d));
+            hi[w] = min(hi[w], e + d);
+            if (lo[w] == hi[w] && !exact[w]) {
+                exact[w] = 1;
+                if (lo[w] > d_lo) { d_lo = lo[w]; r.from = w; r.to = -1; }
+                if (hi[w] < r_hi) { r_hi = hi[w]; r.center = w; }
+            }
+            d_hi = max(d_hi, hi[w]);
+            r_lo = min(r_lo, lo[w]);
+        }
+
+        // Drop the vertices that can no longer move a bound: exact ones, and
+        // unless `all`, those that can be neither farther than d_lo nor
+        // closer than r_hi. W empty means both bounds met.
+        size_t k = 0;
+        for (int w : cand) {
+            const bool drop = exact[w] || (!all && hi[w] <= d_lo && lo[w] >= r_hi);
+            if (!drop) cand[k++] = w;
+        }
+        cand.resize(k);
+        if (cand.empty()) break;
+
+        // Next source: largest upper / smallest lower bound, alternately
+        v = cand[0];
+        for (int w : cand) {
+            const bool better = pick_high
+                ? (hi[w] > hi[v] || (hi[w] == hi[v] && g.degree(w) > g.degree(v)))
+                : (lo[w] < lo[v] || (lo[w] == lo[v] && g.degree(w) > g.degree(v)));
+            if (better) v = w;
+        }
+        pick_high = !pick_high;
+    }
+    if (r.to < 0) {                    // diameter found by bounds: find a partner
+        ecc_bfs(g, r.from, level, &far, r);
+        r.to = far;
+    }
+
+    r.diameter = d_lo; r.diameter_hi = d_hi;
+    r.radius = r_hi; r.radius_lo = r_lo;
+    if (all) {
+        r.ecc.resize(n);
+        for (int w = 0; w < n; ++w) r.ecc[w] = exact[w] ? lo[w] : -1;
+    }
+    return r;
+}
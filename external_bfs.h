@@ -0,0 +1,195 @@
+// external_bfs.h
+// -----------------------------------------------------------------------------
+// Semi-external BFS over a binary CSR file (bfs_par --external graph.bin).
+// -----------------------------------------------------------------------------
+//
+// Only O(n) bits and the frontiers live in RAM: a visited bitmap and a bitmap
+// of the level being discovered (n / 8 bytes each), the current frontier and
+// the next one. Offsets and neighbors stay in the
+// file written by --export --format bin (graph_io.h) and are read per level:
+//   1. The frontier is sorted by vertex ID (a small next frontier is sorted, a
+//      large one is rebuilt in order from its bitmap), so the offsets[u], offsets[u + 1] pairs it needs
+//      lie in increasing file order. Pairs closer than kExtGap are merged into
+//      one extent of at most kExtChunk bytes.
+//   2. The adjacency rows of the frontier are then increasing too (offsets are
+//      monotone); they are merged into extents the same way, long rows split.
+//   3. Both extent lists stream through ReadAhead: --io-threads pread workers
+//      keep the buffers ahead of the BFS, which marks unvisited neighbors in
+//      the bitmap and appends them to the next frontier.
+// So every level reads the file front to back, in large requests, only where
+// the frontier has rows. The frontier is processed in batches so the extent
+// lists stay bounded.
+//
+// Reading through holes trades bytes for requests: a frontier whose vertices
+// are spread over the ID range less than kExtGap apart reads the whole span,
+// so the wide middle levels of a BFS scan about the whole file (a 6 MB file
+// was read as 73 MB over 21 levels, Ext_read_MB). Ext_read_MB against the
+// file size shows this amplification.
+//
+// --ext-mem-mb caps RAM: the bitmap must fit; a quarter of the rest goes to
+// read-ahead buffers (at least two kExtChunk buffers) and the batch lists, the
+// remainder is for the two frontiers. The frontiers cannot be spilled, so a
+// run that goes over the cap anyway reports Ext_over_cap=1 instead of failing.
+//
+// The traversal is level-synchronous over out-edges, like bfs_seq, so the
+// levels are identical; --external-check loads the file and compares.
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include "graph_io.h"
+#include "phase_timer.h"
+using namespace std;
+
+constexpr size_t kExtChunk = size_t(1) << 20;   // bytes per read request
+constexpr uint64_t kExtGap = 64 << 10;          // holes read through rather than split
+
+struct ExtBfsConfig {
+    size_t mem_cap = size_t(256) << 20;
+    int io_threads = 4;
+    bool cold = false;                          // drop the file's page cache first
+};
+
+struct ExtBfsStats {
+    int levels = 0;
+    int64_t visited = 0;
+    int64_t edges = 0;                          // neighbor entries scanned
+    int64_t bytes = 0, reads = 0;               // file traffic
+    double io_wait_s = 0, sort_s = 0, total_s = 0;
+    size_t bitmap_bytes = 0, io_bytes = 0, ram_peak = 0;
+    bool over_cap = false;
+};
+
+// A binary CSR file opened for semi-external traversal.
+struct ExternalCsr {
+    InFile f;
+    CsrFileHeader h;
+    bool open(const string& path) { return f.open(path) && read_csr_header(f, h); }
+    int size() const { return (int)h.n; }
+};
+
+// Groups pieces (increasing positions; neighbors may overlap, like the offset
+// pairs of consecutive vertices) into extents of at most kExtChunk bytes,
+// merging across holes up to kExtGap; first[i] is the first piece of extent i
+// (first.back() == pieces.size()).
+inline void ext_group(const vector<Extent>& pieces, vector<Extent>& ex, vector<size_t>& first) {
+    ex.clear(); first.clear();
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        const Extent& p = pieces[i];
+        if (!ex.empty()) {
+            Extent& e = ex.back();
+            const uint64_t end = max(e.pos + e.len, p.pos + p.len);
+            if (p.pos <= e.pos + e.len + kExtGap && end - e.pos <= kExtChunk) {
+                e.len = (size_t)(end - e.pos);
+                continue;
+            }
+        }
+        ex.push_back(p);
+        first.push_back(i);
+    }
+    first.push_back(pieces.size());
+}
+
+// BFS from s over the file. visit(level, vertices) receives each level's
+// vertices sorted by ID. Returns false (with a message) on a read error or
+// when the bitmap alone exceeds the cap.
+template <class Visit>
+inline bool ext_bfs(ExternalCsr& g, int s, const ExtBfsConfig& c, ExtBfsStats& st, Visit visit) {
+    const double t_start = phase_now();
+    const uint64_t n = g.h.n;
+    vector<uint64_t> vis((n + 63) / 64, 0), fresh(vis.size(), 0);
+    st.bitmap_bytes = bytes_of(vis) + bytes_of(fresh);
+    if (st.bitmap_bytes >= c.mem_cap) { cerr << "--ext-mem-mb is smaller than the visited bitmap\n"; return false; }
+    const size_t rest = c.mem_cap - st.bitmap_bytes;
+    const int depth = (int)max<size_t>(2, min<size_t>(64, rest / 8 / kExtChunk));
+    const size_t batch = max<size_t>(4096, rest / 8 / (2 * sizeof(Extent) + sizeof(size_t)));
+    if (c.cold) g.f.drop_cache();
+
+    ReadAhead ra(g.f, c.io_threads, depth, kExtChunk);
+    vector<int> frontier{s}, next;
+    vector<Extent> pieces, rows, ex;
+    vector<size_t> first;
+    vis[s >> 6] |= 1ULL << (s & 63);
+    visit(0, frontier);
+    st.visited = 1;
+    st.levels = 1;
+    bool ok = true, bad = false;
+
+    for (int level = 1; ok && !frontier.empty(); ++level) {
+        next.clear();
+        for (size_t b0 = 0; ok && b0 < frontier.size(); b0 += batch) {
+            const size_t b1 = min(frontier.size(), b0 + batch);
+            // 1. offsets[u], offsets[u + 1] of the batch -> its adjacency rows
+            pieces.clear();
+            for (size_t j = b0; j < b1; ++j)
+                pieces.push_back({g.h.offsets_pos + (uint64_t)frontier[j] * sizeof(int64_t), 2 * sizeof(int64_t)});
+            ext_group(pieces, ex, first);
+            rows.clear();
+            ok = ra.run(ex, [&](size_t i, const char* data) {
+                for (size_t j = first[i]; j < first[i + 1]; ++j) {
+                    int64_t o[2];
+                    memcpy(o, data + (pieces[j].pos - ex[i].pos), sizeof(o));
+                    // Rows longer than a chunk are split on neighbor boundaries
+                    for (int64_t a = o[0]; a < o[1]; a += (int64_t)(kExtChunk / sizeof(int))) {
+                        const int64_t e = min<int64_t>(o[1], a + (int64_t)(kExtChunk / sizeof(int)));
+                        rows.push_back({g.h.adj_pos + (uint64_t)a * sizeof(int), (size_t)(e - a) * sizeof(int)});
+                    }
+                }
+            });
+            if (!ok) break;
+
+            // 2. The rows: mark and collect unvisited neighbors
+            ext_group(rows, ex, first);
+            ok = ra.run(ex, [&](size_t i, const char* data) {
+                for (size_t j = first[i]; j < first[i + 1]; ++j) {
+                    const int* nb = (const int*)(data + (rows[j].pos - ex[i].pos));
+                    const size_t deg = rows[j].len / sizeof(int);
+                    st.edges += (int64_t)deg;
+                    for (size_t k = 0; k < deg; ++k) {
+                        const int v = nb[k];
+                        if ((uint64_t)(uint32_t)v >= n) { bad = true; continue; }
+                        uint64_t& w = vis[v >> 6];
+                        const uint64_t bit = 1ULL << (v & 63);
+                        if (w & bit) continue;
+                        w |= bit;
+                        fresh[v >> 6] |= bit;
+                        next.push_back(v);
+                    }
+                }
+            });
+            const size_t ram = st.bitmap_bytes + ra.buffer_bytes() + bytes_of(frontier) + bytes_of(next) +
+                               bytes_of(pieces) + bytes_of(rows) + bytes_of(ex) + bytes_of(first);
+            st.ram_peak = max(st.ram_peak, ram);
+        }
+        if (!ok || next.empty()) break;
+        // Order the next frontier: sort when it is small against the bitmap
+        // scan, else read it back from the bitmap
+        const double t0 = phase_now();
+        if (next.size() * 16 < fresh.size()) {
+            sort(next.begin(), next.end());
+            for (int v : next) fresh[v >> 6] = 0;
+        } else {
+            size_t k = 0;
+            for (size_t i = 0; i < fresh.size(); ++i)
+                for (uint64_t w = fresh[i]; w; w &= w - 1) next[k++] = (int)(i * 64 + __builtin_ctzll(w));
+            fill(fresh.begin(), fresh.end(), 0);
+        }
+        st.sort_s += phase_now() - t0;
+        visit(level, next);
+        st.visited += (int64_t)next.size();
+        st.levels++;
+        frontier.swap(next);
+    }
+    st.bytes = ra.bytes; st.reads = ra.reads;
+    st.io_wait_s = ra.wait_s;
+    st.io_bytes = ra.buffer_bytes();
+    st.over_cap = st.ram_peak > c.mem_cap;
+    st.total_s = phase_now() - t_start;
+    if (!ok) cerr << "Read error in the CSR file\n";
+    if (bad) cerr << "Neighbor ID out of range in the CSR file\n";
+    return ok && !bad;
+}
@@ -0,0 +1,534 @@
+// graph_io.h
+// -----------------------------------------------------------------------------
+// Graph export for both drivers (--export <path> --format el|bin|dot),
+// MappedFile for the index files that are queried in place, and positioned
+// reads of binary CSR files (InFile, ReadAhead, load_csr_bin).
+// -----------------------------------------------------------------------------
+//
+// Formats (undirected graphs write every edge once, as u < v, like edges.txt;
+// directed graphs write every u -> v):
+//   el   edge list, one "u v" line per edge (readable back with --file)
+//   dot  GraphViz: "graph G {", one "u -- v;" line per edge ("digraph G {" and
+//        "u -> v;" when directed), "}" - the layout of graph.dot
+//   bin  the CSR arrays as they are in memory, see CsrFileHeader below
+//
+// Text is produced by a parallel formatter: the vertices are cut into chunks of
+// about kExportChunkEdges edges, each thread converts whole chunks to text in
+// its own buffer (hand-rolled integer formatting, no iostreams), and the
+// buffers of a round of chunks are written with pwrite() at their prefix-sum
+// offsets, so the file comes out in vertex order without a serial copy. Memory
+// stays bounded by one round of buffers. Without POSIX I/O the buffers are
+// written in order through an ofstream.
+//
+// ReadAhead streams a list of extents (byte ranges) of an InFile to one
+// consumer in order: a pool of pread() workers, started once per ReadAhead,
+// keeps up to `depth` fixed-size buffers in flight ahead of it, and a worker only claims the next extent once
+// its buffer slot has been consumed, so memory stays at depth buffers however
+// long the list (external_bfs.h reads adjacency this way).
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "graph_utils.h"
+#include "mem_utils.h"
+#include "phase_timer.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+using namespace std;
+
+// Binary CSR file ("bin"): this header, then the n + 1 int64 offsets at
+// offsets_pos and the m int32 neighbors at adj_pos, both little-endian as in
+// memory and aligned to kCsrAlign so the arrays can be mmap'ed or read with
+// page-aligned pread().
+constexpr uint32_t kCsrVersion = 1;
+constexpr uint32_t kCsrDirected = 1;   // flags bit: edges are directed
+constexpr uint64_t kCsrAlign = 4096;
+
+struct CsrFileHeader {
+    char magic[8];         // "BFSCSR1" + NUL
+    uint32_t version;      // kCsrVersion
+    uint32_t flags;        // kCsrDirected
+    uint64_t n;            // vertices
+    uint64_t m;            // neighbor entries (undirected edges count twice)
+    uint64_t offsets_pos;  // byte position of offsets[0 .. n]
+    uint64_t adj_pos;      // byte position of adj[0 .. m)
+};
+static_assert(sizeof(CsrFileHeader) == 48, "CsrFileHeader layout");
+
+static const char kCsrMagic[8] = {'B', 'F', 'S', 'C', 'S', 'R', '1', '\0'};
+static const int64_t kExportChunkEdges = int64_t(1) << 20;
+
+// Output file written at explicit offsets (pwrite) or, without POSIX I/O,
+// strictly in order.
+class OutFile {
+public:
+    bool open(const string& path) {
+#if defined(__unix__) || defined(__APPLE__)
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        return fd_ >= 0;
+#else
+        out_.open(path, ios::binary | ios::trunc);
+        return (bool)out_;
+#endif
+    }
+    // Thread-safe on POSIX; elsewhere callers write in increasing pos order.
+    bool write_at(const char* p, size_t len, uint64_t pos) {
+#if defined(__unix__) || defined(__APPLE__)
+        while (len > 0) {
+            ssize_t w = ::pwrite(fd_, p, len, (off_t)pos);
+            if (w <= 0) return false;
+            p += w; len -= (size_t)w; pos += (uint64_t)w;
+        }
+        return true;
+#else
+        out_.seekp((streamoff)pos);
+        out_.write(p, (streamsize)len);
+        return (bool)out_;
+#endif
+    }
+    bool close() {
+#if defined(__unix__) || defined(__APPLE__)
+        bool ok = fd_ >= 0 && ::close(fd_) == 0;
+        fd_ = -1;
+        return ok;
+#else
+        out_.close();
+        return !out_.fail();
+#endif
+    }
+    static constexpr bool parallel() {
+#if defined(__unix__) || defined(__APPLE__)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+private:
+#if defined(__unix__) || defined(__APPLE__)
+    int fd_ = -1;
+#else
+    ofstream out_;
+#endif
+};
+
+// Input file read at explicit offsets: pread() from any thread or, without
+// POSIX I/O, one ifstream behind a lock.
+class InFile {
+public:
+    InFile() = default;
+    InFile(const InFile&) = delete;
+    InFile& operator=(const InFile&) = delete;
+    ~InFile() { close(); }
+
+    bool open(const string& path) {
+        close();
+#if defined(__unix__) || defined(__APPLE__)
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd_ < 0 || fstat(fd_, &st) != 0) { close(); return false; }
+        size_ = (uint64_t)st.st_size;
+        return true;
+#else
+        in_.open(path, ios::binary);
+        if (!in_) return false;
+        in_.seekg(0, ios::end);
+        size_ = (uint64_t)in_.tellg();
+        return true;
+#endif
+    }
+    bool read_at(char* p, size_t len, uint64_t pos) {
+#if defined(__unix__) || defined(__APPLE__)
+        while (len > 0) {
+            const ssize_t r = ::pread(fd_, p, len, (off_t)pos);
+            if (r <= 0) return false;
+            p += r; len -= (size_t)r; pos += (uint64_t)r;
+        }
+        return true;
+#else
+        lock_guard<mutex> lk(mu_);
+        in_.seekg((streamoff)pos);
+        in_.read(p, (streamsize)len);
+        return (bool)in_;
+#endif
+    }
+    // Drops the file's cached pages (cold-cache benchmarks); false if unsupported.
+    bool drop_cache() {
+#if defined(__linux__)
+        return posix_fadvise(fd_, 0, 0, POSIX_FADV_DONTNEED) == 0;
+#else
+        return false;
+#endif
+    }
+    void close() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+#else
+        if (in_.is_open()) in_.close();
+#endif
+        size_ = 0;
+    }
+    uint64_t size() const { return size_; }
+
+private:
+    uint64_t size_ = 0;
+#if defined(__unix__) || defined(__APPLE__)
+    int fd_ = -1;
+#else
+    ifstream in_;
+    mutex mu_;
+#endif
+};
+
+// Byte range of a file.
+struct Extent {
+    uint64_t pos;
+    size_t len;
+};
+
+// Reads extents of at most `max_len` bytes with `threads` workers and `depth`
+// buffers (see the header comment). Counts bytes, reads and the time the
+// consumer waited for data. The workers live as long as the object and wait
+// on the condition variable between runs.
+class ReadAhead {
+public:
+    ReadAhead(InFile& f, int threads, int depth, size_t max_len)
+        : f_(f), threads_(max(threads, 1)), depth_(max(depth, 1)), max_len_(max_len),
+          buf_((size_t)depth_ * max_len), ready_(depth_, -1) {
+        if (threads_ > 1)
+            for (int t = 0; t < min(threads_, depth_); ++t) pool_.emplace_back([this] { worker(); });
+    }
+    ReadAhead(const ReadAhead&) = delete;
+    ReadAhead& operator=(const ReadAhead&) = delete;
+    ~ReadAhead() {
+        {
+            lock_guard<mutex> lk(mu_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (thread& t : pool_) t.join();
+    }
+
+    // Calls consume(i, data) for every extent i in order on the calling
+    // thread, data holding ex[i].len bytes from ex[i].pos. False if a read fails.
+    template <class Consume>
+    bool run(const vector<Extent>& ex, Consume consume) {
+        const size_t k = ex.size();
+        for (const Extent& e : ex) { bytes += (int64_t)e.len; reads++; }
+        if (pool_.empty() || k <= 1) {
+            for (size_t i = 0; i < k; ++i) {
+                const double t0 = phase_now();
+                if (!f_.read_at(buf_.data(), ex[i].len, ex[i].pos)) return false;
+                wait_s += phase_now() - t0;
+                consume(i, (const char*)buf_.data());
+            }
+            return true;
+        }
+
+        {
+            lock_guard<mutex> lk(mu_);
+            ex_ = &ex; k_ = k;
+            issued_ = consumed_ = 0;
+            fill(ready_.begin(), ready_.end(), -1);
+            failed_ = false;
+        }
+        cv_.notify_all();
+        for (size_t i = 0; i < k; ++i) {
+            {
+                const double t0 = phase_now();
+                unique_lock<mutex> lk(mu_);
+                cv_.wait(lk, [&] { return failed_ || ready_[i % depth_] == (int64_t)i; });
+                wait_s += phase_now() - t0;
+                if (failed_) break;
+            }
+            consume(i, (const char*)buf_.data() + (i % depth_) * max_len_);
+            lock_guard<mutex> lk(mu_);
+            consumed_ = i + 1;
+            cv_.notify_all();
+        }
+        // Withdraw the list and let reads in flight finish before ex goes away
+        unique_lock<mutex> lk(mu_);
+        ex_ = nullptr;
+        cv_.wait(lk, [&] { return active_ == 0; });
+        return !failed_;
+    }
+
+    size_t buffer_bytes() const { return bytes_of(buf_); }
+    int64_t bytes = 0, reads = 0;
+    double wait_s = 0;
+
+private:
+    void worker() {
+        for (;;) {
+            size_t i;
+            const Extent* e;
+            {
+                unique_lock<mutex> lk(mu_);
+                cv_.wait(lk, [&] { return stop_ || (ex_ && !failed_ && issued_ < k_ && issued_ < consumed_ + depth_); });
+                if (stop_) return;
+                i = issued_++;
+                e = &(*ex_)[i];
+                active_++;
+            }
+            char* slot = buf_.data() + (i % depth_) * max_len_;
+            const bool ok = f_.read_at(slot, e->len, e->pos);
+            lock_guard<mutex> lk(mu_);
+            if (!ok) failed_ = true;
+            ready_[i % depth_] = (int64_t)i;
+            active_--;
+            cv_.notify_all();
+        }
+    }
+
+    InFile& f_;
+    int threads_, depth_;
+    size_t max_len_;
+    page_vector<char> buf_;
+    // Current run, guarded by mu_
+    mutex mu_;
+    condition_variable cv_;
+    const vector<Extent>* ex_ = nullptr;
+    size_t k_ = 0, issued_ = 0, consumed_ = 0;
+    vector<int64_t> ready_;                  // extent held by each slot
+    int active_ = 0;                         // reads in flight
+    bool failed_ = false, stop_ = false;
+    vector<thread> pool_;
+};
+
+// Reads and checks the header of a binary CSR file.
+inline bool read_csr_header(InFile& f, CsrFileHeader& h) {
+    if (f.size() < sizeof(h) || !f.read_at((char*)&h, sizeof(h), 0)) return false;
+    return memcmp(h.magic, kCsrMagic, sizeof(h.magic)) == 0 && h.version == kCsrVersion &&
+           h.n < (uint64_t)INT32_MAX && h.offsets_pos + (h.n + 1) * sizeof(int64_t) <= f.size() &&
+           h.adj_pos + h.m * sizeof(int) <= f.size();
+}
+
+// Loads a whole binary CSR file (--export --format bin) into g, 8 MiB slices
+// read in parallel. Returns false (with a message) on failure.
+inline bool load_csr_bin(const string& path, Graph& g, bool* directed = nullptr) {
+    InFile f;
+    CsrFileHeader h;
+    if (!f.open(path) || !read_csr_header(f, h)) { cerr << "Not a binary CSR file: " << path << "\n"; return false; }
+    g.offsets.resize(h.n + 1);
+    g.adj.resize(h.m);
+    struct Slice { char* p; size_t len; uint64_t pos; };
+    vector<Slice> slices;
+    auto add = [&](char* p, size_t len, uint64_t pos) {
+        const size_t step = size_t(8) << 20;
+        for (size_t o = 0; o < len; o += step) slices.push_back({p + o, min(step, len - o), pos + o});
+    };
+    add((char*)g.offsets.data(), (h.n + 1) * sizeof(int64_t), h.offsets_pos);
+    add((char*)g.adj.data(), h.m * sizeof(int), h.adj_pos);
+    bool ok = true;
+    BFS_OMP(omp parallel for schedule(dynamic, 1) reduction(&&:ok))
+    for (size_t i = 0; i < slices.size(); ++i)
+        ok = f.read_at(slices[i].p, slices[i].len, slices[i].pos) && ok;
+    if (!ok) { cerr << "Failed to read " << path << "\n"; return false; }
+    if (directed) *directed = (h.flags & kCsrDirected) != 0;
+    return true;
+}
+
+// Input file for index formats queried in place (pll.h, reach.h): mmap'ed
+// read-only where available, read into memory otherwise.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const string& path) {
+        close();
+#if defined(__unix__) || defined(__APPLE__)
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); return false; }
+        size_ = (size_t)st.st_size;
+        void* p = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) { size_ = 0; return false; }
+        base_ = (const char*)p;
+        mapped_ = true;
+#else
+        ifstream f(path, ios::binary);
+        if (!f) return false;
+        buf_.assign(istreambuf_iterator<char>(f), istreambuf_iterator<char>());
+        base_ = buf_.data();
+        size_ = buf_.size();
+#endif
+        return true;
+    }
+
+    void close() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (mapped_) munmap((void*)base_, size_);
+#endif
+        buf_.clear();
+        base_ = nullptr; size_ = 0; mapped_ = false;
+    }
+
+    const char* data() const { return base_; }
+    size_t size() const { return size_; }
+    bool mapped() const { return mapped_; }
+
+private:
+    const char* base_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    vector<char> buf_;
+};
+
+// Decimal digits of x at p; returns the end.
+inline char* put_uint(char* p, uint32_t x) {
+    static const char pairs[201] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    char tmp[10];
+    char* t = tmp + 10;
+    while (x >= 100) {
+        const uint32_t r = x % 100; x /= 100;
+        *--t = pairs[2 * r + 1]; *--t = pairs[2 * r];
+    }
+    if (x >= 10) { *--t = pairs[2 * x + 1]; *--t = pairs[2 * x]; }
+    else *--t = (char)('0' + x);
+    const size_t len = (size_t)(tmp + 10 - t);
+    memcpy(p, t, len);
+    return p + len;
+}
+
+// Writes the edge lines of g starting at byte `pos`; returns the bytes written
+// (or -1). `line(p, u, v)` formats one edge at p and returns the end; it may
+// write at most kMaxLine bytes.
+template <class LineFn>
+inline int64_t export_edge_text(const Graph& g, bool directed, OutFile& f, uint64_t pos,
+                                LineFn line) {
+    constexpr size_t kMaxLine = 32;
+    const int n = g.size();
+    int P = 1;
+    #ifdef _OPENMP
+    P = omp_get_max_threads();
+    #endif
+
+    // Vertex chunks of about kExportChunkEdges neighbor entries
+    vector<int> bounds{0};
+    int64_t acc = 0;
+    for (int u = 0; u < n; ++u) {
+        acc += g.degree(u);
+        if (acc >= kExportChunkEdges) { bounds.push_back(u + 1); acc = 0; }
+    }
+    if (bounds.back() != n) bounds.push_back(n);
+    const int chunks = (int)bounds.size() - 1;
+
+    vector<page_vector<char>> buf(P);
+    vector<uint64_t> at(P + 1);
+    const uint64_t start = pos;
+    bool ok = true;
+    for (int c0 = 0; c0 < chunks && ok; c0 += P) {
+        const int k = min(P, chunks - c0);
+        // Format: one chunk per thread
+        BFS_OMP(omp parallel for schedule(dynamic, 1))
+        for (int c = 0; c < k; ++c) {
+            const int lo = bounds[c0 + c], hi = bounds[c0 + c + 1];
+            page_vector<char>& b = buf[c];
+            b.resize((size_t)(g.offsets[hi] - g.offsets[lo]) * kMaxLine);
+            char* p = b.data();
+            for (int u = lo; u < hi; ++u)
+                for (int v : g[u])
+                    if (directed || u < v) p = line(p, u, v);
+            b.resize((size_t)(p - b.data()));
+        }
+        // Write: each buffer at its prefix-sum offset
+        at[0] = pos;
+        for (int c = 0; c < k; ++c) at[c + 1] = at[c] + buf[c].size();
+        BFS_OMP(omp parallel for schedule(dynamic, 1) if(OutFile::parallel()) reduction(&&:ok))
+        for (int c = 0; c < k; ++c)
+            ok = f.write_at(buf[c].data(), buf[c].size(), at[c]) && ok;
+        pos = at[k];
+    }
+    return ok ? (int64_t)(pos - start) : -1;
+}
+
+// Binary CSR file, see CsrFileHeader. Returns the bytes written (or -1).
+inline int64_t export_csr_bin(const Graph& g, bool directed, OutFile& f) {
+    auto align = [](uint64_t x) { return (x + kCsrAlign - 1) / kCsrAlign * kCsrAlign; };
+    CsrFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, kCsrMagic, sizeof(h.magic));
+    h.version = kCsrVersion;
+    h.flags = directed ? kCsrDirected : 0;
+    h.n = (uint64_t)g.size();
+    h.m = (uint64_t)g.num_edges();
+    h.offsets_pos = align(sizeof(h));
+    h.adj_pos = align(h.offsets_pos + (h.n + 1) * sizeof(int64_t));
+
+    // Header, then both arrays in 8 MiB slices written in parallel
+    struct Slice { const char* p; size_t len; uint64_t pos; };
+    vector<Slice> slices{{(const char*)&h, sizeof(h), 0}};
+    auto add = [&](const char* p, size_t len, uint64_t pos) {
+        const size_t step = size_t(8) << 20;
+        for (size_t o = 0; o < len; o += step)
+            slices.push_back({p + o, min(step, len - o), pos + o});
+    };
+    add((const char*)g.offsets.data(), (h.n + 1) * sizeof(int64_t), h.offsets_pos);
+    add((const char*)g.adj.data(), h.m * sizeof(int), h.adj_pos);
+
+    bool ok = true;
+    BFS_OMP(omp parallel for schedule(dynamic, 1) if(OutFile::parallel()) reduction(&&:ok))
+    for (size_t i = 0; i < slices.size(); ++i)
+        ok = f.write_at(slices[i].p, slices[i].len, slices[i].pos) && ok;
+    return ok ? (int64_t)(h.adj_pos + h.m * sizeof(int)) : -1;
+}
+
+// --export: write g to `path` in `format` (el, dot or bin). Timed as the
+// "export" phase. Returns false (with a message) on failure.
+inline bool export_graph(const Graph& g, const string& path, const string& format, bool directed) {
+    const double t0 = phase_now();
+    OutFile f;
+    if (!f.open(path)) { cerr << "Failed to open " << path << "\n"; return false; }
+
+    int64_t bytes = -1;
+    if (format == "el") {
+        bytes = export_edge_text(g, directed, f, 0, [](char* p, int u, int v) {
+            p = put_uint(p, (uint32_t)u); *p++ = ' ';
+            p = put_uint(p, (uint32_t)v); *p++ = '\n';
+            return p;
+        });
+    } else if (format == "dot") {
+        const string head = directed ? "digraph G {\n" : "graph G {\n";
+        const char* arrow = directed ? " -> " : " -- ";
+        int64_t body = -1;
+        if (f.write_at(head.data(), head.size(), 0))
+            body = export_edge_text(g, directed, f, head.size(), [arrow](char* p, int u, int v) {
+                p = put_uint(p, (uint32_t)u); memcpy(p, arrow, 4); p += 4;
+                p = put_uint(p, (uint32_t)v); *p++ = ';'; *p++ = '\n';
+                return p;
+            });
+        if (body >= 0 && f.write_at("}\n", 2, head.size() + body))
+            bytes = (int64_t)head.size() + body + 2;
+    } else if (format == "bin") {
+        bytes = export_csr_bin(g, directed, f);
+    }
+    if (!f.close() || bytes < 0) { cerr << "Failed to write " << path << "\n"; return false; }
+
+    const int64_t edges = directed ? g.num_edges() : g.num_edges() / 2;
+    phase_timer().add("export", phase_now() - t0, bytes, edges);
+    return true;
+}
@@ -5,16 +5,85 @@
 // they run on the *same inputs* for fair comparison.
 // -----------------------------------------------------------------------------
 //
-// Graph model: undirected adjacency list (vector<vector<int>>).
+// Graph model: compressed sparse row (CSR). The neighbors of u are the slice
+// adj[offsets[u] .. offsets[u+1]), sorted and without duplicates; g[u] returns
+// that slice, so traversal code reads `for (int v : g[u])`.
 // Synthetic generator: builds a random graph with approximately `avg_deg` edges
 // per vertex (without self-loops, with simple dedup).
+// Both builders first-touch the CSR arrays in parallel (see mem_utils.h) and
+// time their phases in phase_timer() (see phase_timer.h).
 //
 // CLI usage (recognized by both executables):
 //   --n <int>        number of vertices (default 10000)        [ignored if --file]
 //   --deg <int>      approximate average degree (default 8)     [ignored if --file]
 //   --start <int>    BFS start vertex (default 0)
 //   --file <path>    load undirected edge list "u v" (0-based indices)
+//   --ingest <pipeline|stream>  --file loader: overlapped pread/parse/build
+//                    (default, see ingest.h) or the serial istream reader
 //   --seed <uint64>  RNG seed for synthetic graph (default 42)
+//   --iters <int>    repeat each BFS this many times (default 1)
+//   --directed       synthetic graph keeps edge direction
+//   --interleave     interleave the neighbor array across NUMA nodes
+//   --hugepages      back large arrays with 2 MiB pages (Linux)
+//   --numa-bench     bfs_par only: report per-node memory bandwidth and exit
+//   --engine <name>  bfs_par only: parallel engine, level (default) | owner | chunked
+//   --grain <int>    bfs_par only: frontier edges per thread for the level engine
+//                    (default: calibrated at startup; smaller levels run serially)
+//   --stats <path>   bfs_par built with -DBFS_INSTRUMENT: per-level statistics
+//   --stats-format <json|csv>  format of --stats (default json)
+//   --trace <path>   bfs_par built with -DBFS_TRACE: Chrome trace-event JSON of
+//                    the level engine's per-thread activity
+//   --perf           bfs_par only: hardware counters per phase (Linux perf_event)
+//   --teps           bfs_par only: Graph500 kernel 2 style TEPS benchmark over
+//                    random roots with non-zero degree (seeded by --seed)
+//   --roots <int>    number of roots for --teps (default 64)
+//   --cc <bfs|afforest>  bfs_par only: connected components (components.h)
+//   --cc-out <path>  with --cc: component ID of every vertex, one per line
+//   --scc <fwbw|tarjan>  bfs_par only: strongly connected components and the
+//                    condensation DAG (scc.h)
+//   --scc-out <path> with --scc: component ID of every vertex, one per line
+//   --scc-dag-out <path>  with --scc: condensation DAG as "a b" lines
+//   --bc             bfs_par only: betweenness centrality (betweenness.h), exact
+//   --bc-samples <int>  with --bc: approximate from this many random sources
+//   --bc-batch <int> with --bc: sources per bit-parallel sweep, 1..64 (default 16)
+//   --closeness      bfs_par only: exact closeness and harmonic centrality of
+//                    every vertex (closeness.h)
+//   --closeness-samples <int>  sampled top-k by harmonic centrality instead
+//   --topk <int>     vertices listed by --bc/--closeness (default 10)
+//   --closeness-out <path>  with --closeness: "closeness harmonic" per vertex
+//   --diameter <ifub|tk>  bfs_par only: exact diameter (tk: and radius) of the
+//                    largest component with few BFS runs (diameter.h)
+//   --ecc-out <path> with --diameter tk: eccentricity of every vertex
+//   --pll-build <path>  bfs_par only: build the exact distance index (pll.h),
+//                    save it, then benchmark queries on the saved file
+//   --pll <path>     bfs_par only: benchmark queries on an existing index
+//   --queries <int>  random (s, t) pairs for --pll/--pll-build/--landmarks/
+//                    --reach/--reach-build (default 10000)
+//   --reach-build <path>  bfs_par only: build the reachability index (reach.h),
+//                    save it, then benchmark queries on the saved file
+//   --reach <path>   bfs_par only: benchmark queries on an existing index
+//   --reach-labels <int>  interval labels per component (default 4, max 16)
+//   --serve <path|->  bfs_par only: keep the graph loaded and answer dist, path,
+//                    k-hop and reach queries on a Unix domain socket (or stdin/
+//                    stdout with -) until a shutdown request (query_server.h);
+//                    --pll / --reach indexes are used for dist / reach
+//   --serve-threads <int>  socket workers (default: OpenMP thread count)
+//   --cache-mb <int> with --serve: LRU cache of BFS levels from hot sources,
+//                    this many MiB (default 0: off; bfs_cache.h)
+//   --cache-admit <int>  misses of a source before its BFS is cached (default 2)
+//   --landmarks <int>  bfs_par only: approximate distance oracle from K
+//                    landmarks (landmarks.h); reports bounds accuracy
+//   --landmark-select <degree|random|farthest>  landmark choice (default degree)
+//   --external <path>  bfs_par only: semi-external BFS from --start over a
+//                    binary CSR file (--export --format bin) without loading
+//                    it; RAM holds the visited bitmap and frontiers (external_bfs.h)
+//   --ext-mem-mb <int>  RAM cap of --external (default 256)
+//   --io-threads <int>  pread workers of --external and of the pipelined
+//                    --file loader (default 4)
+//   --ext-cold       with --external: drop the file's page cache first (Linux)
+//   --external-check with --external: load the file and compare with bfs_seq
+//   --export <path>  write the graph after loading (see graph_io.h)
+//   --format <el|bin|dot>  format of --export (default el: "u v" lines)
 //
 // Example (synthetic):
 //   ./bfs_seq  --n 100000 --deg 8 --start 0
@@ -31,91 +100,385 @@
 #include <iostream>
 #include <cstdint>
 #include <fstream>
+#include <utility>
+#include <iomanip>
+#include "mem_utils.h"
+#include "phase_timer.h"
 using namespace std;
 
-// Simple adjacency-list graph
-using Graph = vector<vector<int>>;
+// Neighbor list of one vertex: a read-only slice of Graph::adj.
+struct AdjSpan {
+    const int* b;
+    const int* e;
+    const int* begin() const { return b; }
+    const int* end() const { return e; }
+    size_t size() const { return (size_t)(e - b); }
+    bool empty() const { return b == e; }
+    int operator[](size_t i) const { return b[i]; }
+};
+
+// Compressed sparse row graph. For undirected graphs every edge is stored in
+// both directions, so num_edges() counts each undirected edge twice.
+struct Graph {
+    page_vector<int64_t> offsets;  // n + 1 entries
+    page_vector<int>     adj;      // offsets[n] entries
+
+    int size() const { return offsets.empty() ? 0 : (int)offsets.size() - 1; }
+    int64_t num_edges() const { return (int64_t)adj.size(); }
+    int degree(int u) const { return (int)(offsets[u + 1] - offsets[u]); }
+    AdjSpan operator[](int u) const {
+        return { adj.data() + offsets[u], adj.data() + offsets[u + 1] };
+    }
+    size_t bytes() const { return bytes_of(offsets) + bytes_of(adj); }
+};
+
+// Memory report of a driver: the graph's footprint and the process peak RSS
+// after loading it and after the BFS runs, per stored (directed) edge.
+inline void print_memory(ostream& out, const Graph& g, size_t rss_load, size_t rss_bfs) {
+    const ios::fmtflags flags = out.flags();
+    const streamsize prec = out.precision();
+    const double m = (double)max<int64_t>(1, g.num_edges());
+    out << fixed << setprecision(2)
+        << "Mem_graph_bytes=" << g.bytes() << " Mem_offsets_bytes=" << bytes_of(g.offsets)
+        << " Mem_adj_bytes=" << bytes_of(g.adj) << " Graph_bytes_per_edge=" << g.bytes() / m << "\n"
+        << "Peak_rss_load_bytes=" << rss_load << " Rss_bytes_per_edge_load=" << rss_load / m
+        << " Peak_rss_bfs_bytes=" << rss_bfs << " Rss_bytes_per_edge_bfs=" << rss_bfs / m << "\n";
+    out.flags(flags);
+    out.precision(prec);
+}
+
+// Build a CSR graph over vertices [0, n) from an edge list. Each pair (u, v)
+// adds u->v and, unless `directed`, v->u. Neighbor lists are sorted and
+// deduplicated. Vertex rows are first-touched with a static schedule so each
+// thread's block of the arrays lives on its own NUMA node; with `interleave`
+// the neighbor array is instead spread round-robin over all nodes.
+inline Graph build_csr(int n, const vector<pair<int, int>>& edges, bool directed,
+                       bool interleave = false) {
+    const int64_t E = (int64_t)edges.size();
+    double t_build = phase_now();
+
+    // Degree counting
+    page_vector<int64_t> deg(n + 1);
+    first_touch_fill(deg.data(), deg.size(), int64_t(0));
+    BFS_OMP(omp parallel for schedule(static))
+    for (int64_t i = 0; i < E; ++i) {
+        BFS_OMP(omp atomic)
+        deg[edges[i].first + 1]++;
+        if (!directed) {
+            BFS_OMP(omp atomic)
+            deg[edges[i].second + 1]++;
+        }
+    }
+    for (int u = 0; u < n; ++u) deg[u + 1] += deg[u];
+
+    // Scatter into a scratch CSR (rows unsorted, may contain duplicates)
+    page_vector<int> tmp(deg[n]);
+    vector<int64_t> cursor(deg.begin(), deg.end() - 1);
+    BFS_OMP(omp parallel for schedule(static))
+    for (int64_t i = 0; i < E; ++i) {
+        int u = edges[i].first, v = edges[i].second;
+        int64_t p;
+        BFS_OMP(omp atomic capture)
+        p = cursor[u]++;
+        tmp[p] = v;
+        if (!directed) {
+            BFS_OMP(omp atomic capture)
+            p = cursor[v]++;
+            tmp[p] = u;
+        }
+    }
+
+    // Sort + dedup each row; cursor[u] becomes the row's final length
+    const double t_sort = phase_now();
+    BFS_OMP(omp parallel for schedule(dynamic, 1024))
+    for (int u = 0; u < n; ++u) {
+        int* b = tmp.data() + deg[u];
+        int* e = tmp.data() + deg[u + 1];
+        sort(b, e);
+        cursor[u] = unique(b, e) - b;
+    }
+    const double sort_s = phase_now() - t_sort;
+    phase_timer().add("sort_dedup", sort_s, 0, (int64_t)deg[n]);
+    t_build += sort_s; // csr_build excludes the sort
+
+    // Compact into the final arrays
+    Graph g;
+    g.offsets.resize(n + 1);
+    first_touch_fill(g.offsets.data(), g.offsets.size(), int64_t(0));
+    for (int u = 0; u < n; ++u) g.offsets[u + 1] = g.offsets[u] + cursor[u];
+    g.adj.resize(g.offsets[n]);
+    if (interleave) numa_interleave(g.adj.data(), g.adj.size() * sizeof(int));
+    BFS_OMP(omp parallel for schedule(static))
+    for (int u = 0; u < n; ++u)
+        copy(tmp.data() + deg[u], tmp.data() + deg[u] + cursor[u],
+             g.adj.data() + g.offsets[u]);
+    phase_timer().add("csr_build", phase_now() - t_build, 0, E);
+    return g;
+}
+
+// Reverse of a directed CSR graph: u -> v becomes v -> u. Scanning u in order
+// keeps the reversed rows sorted.
+inline Graph transpose(const Graph& g) {
+    const int n = g.size();
+    Graph t;
+    t.offsets.resize(n + 1);
+    first_touch_fill(t.offsets.data(), t.offsets.size(), int64_t(0));
+    for (int v : g.adj) t.offsets[v + 1]++;
+    for (int u = 0; u < n; ++u) t.offsets[u + 1] += t.offsets[u];
+    t.adj.resize(g.adj.size());
+    vector<int64_t> cursor(t.offsets.begin(), t.offsets.end() - 1);
+    for (int u = 0; u < n; ++u)
+        for (int v : g[u]) t.adj[cursor[v]++] = u;
+    return t;
+}
+
+// Undirected view of a directed CSR graph: u and v are neighbors when u -> v
+// or v -> u. Rows are the sorted union of the out- and in-neighbor rows.
+inline Graph symmetrize(const Graph& g) {
+    const int n = g.size();
+    const Graph t = transpose(g);
+    Graph s;
+    s.offsets.resize(n + 1);
+    first_touch_fill(s.offsets.data(), s.offsets.size(), int64_t(0));
+    vector<int> row;
+    for (int u = 0; u < n; ++u) {
+        row.clear();
+        set_union(g[u].begin(), g[u].end(), t[u].begin(), t[u].end(), back_inserter(row));
+        s.offsets[u + 1] = s.offsets[u] + (int64_t)row.size();
+    }
+    s.adj.resize(s.offsets[n]);
+    BFS_OMP(omp parallel for schedule(dynamic, 1024))
+    for (int u = 0; u < n; ++u)
+        set_union(g[u].begin(), g[u].end(), t[u].begin(), t[u].end(), s.adj.data() + s.offsets[u]);
+    return s;
+}
 
 // Build an undirected random graph with ~avg_deg neighbors per vertex.
-inline Graph make_synthetic_graph(int n, int avg_deg, bool directed, uint64_t seed = 42) {
-    Graph g(n);
+inline Graph make_synthetic_graph(int n, int avg_deg, bool directed, uint64_t seed = 42,
+                                  bool interleave = false) {
+    vector<pair<int, int>> edges;
     if (avg_deg < 0) avg_deg = 0;
     if (avg_deg > n - 1) avg_deg = n - 1;  // can't have more neighbors than (n-1)
 
+    const double t0 = phase_now();
     mt19937_64 rng(seed);
     uniform_int_distribution<int> dist(0, n - 1);
 
+    edges.reserve((size_t)n * avg_deg);
     for (int u = 0; u < n; ++u) {
         unordered_set<int> seen;
         while ((int)seen.size() < avg_deg) {
             int v = dist(rng);
             if (v != u) seen.insert(v); // avoid self-loop
         }
-        for (int v : seen) {
-            g[u].push_back(v);
-            if (!directed) {
-                g[v].push_back(u);
-            }
-        }
+        for (int v : seen) edges.push_back({u, v});
     }
+    phase_timer().add("generate", phase_now() - t0, 0, (int64_t)edges.size());
 
-    // Final global cleanup: guarantee sorted + unique neighbor lists for all nodes
-    for (int u = 0; u < n; ++u) {
-        auto& adj = g[u];
-        sort(adj.begin(), adj.end());
-        adj.erase(unique(adj.begin(), adj.end()), adj.end());
-    }
-    return g;
+    // CSR build also symmetrizes (undirected) and sorts + dedups neighbor lists
+    return build_csr(n, edges, directed, interleave);
 }
 
 
 // Load an undirected graph from a simple edge list file with lines "u v".
 // Assumes 0-based vertex IDs and ignores invalid pairs/out-of-range lines.
-inline Graph load_edgelist(istream& in, int n) {
-    Graph g(n);
+inline Graph load_edgelist(istream& in, int n, bool interleave = false) {
+    const double t0 = phase_now();
+    int64_t bytes = 0; // input size for the parse throughput, if seekable
+    const streampos beg = in.tellg();
+    if (beg != streampos(-1) && in.seekg(0, ios::end)) {
+        bytes = (int64_t)(in.tellg() - beg);
+        in.seekg(beg);
+    }
+    in.clear();
+
+    vector<pair<int, int>> edges;
     int u, v;
     while (in >> u >> v) {
         if (u >= 0 && u < n && v >= 0 && v < n && u != v) {
-            g[u].push_back(v);
-            g[v].push_back(u);
+            edges.push_back({u, v});
         }
     }
-    for (int u = 0; u < n; ++u) {
-        sort(g[u].begin(), g[u].end());
-        g[u].erase(unique(g[u].begin(), g[u].end()), g[u].end());
-    }
-    return g;
+    phase_timer().add("parse", phase_now() - t0, bytes, (int64_t)edges.size());
+    return build_csr(n, edges, /*directed=*/false, interleave);
 }
 
 // Print short usage help to stderr (used when arguments are invalid).
 inline void usage(const char* prog) {
     cerr << "Usage:\n"
          << "  " << prog << " --n 100000 --deg 8 --start 0 [--seed 42]\n"
-         << "  " << prog << " --n 100000 --start 0 --file input.txt\n";
+         << "  " << prog << " --n 100000 --start 0 --file input.txt [--ingest pipeline|stream]\n"
+         << "Options: --iters N --directed --interleave --numa-bench --hugepages\n"
+         << "         --engine level|owner|chunked --grain N\n"
+         << "         --stats out.json [--stats-format json|csv] --trace trace.json --perf\n"
+         << "         --teps [--roots 64] --export out.el [--format el|bin|dot]\n"
+         << "         --cc bfs|afforest [--cc-out ids.txt]\n"
+         << "         --scc fwbw|tarjan [--scc-out ids.txt] [--scc-dag-out dag.txt]\n"
+         << "         --bc [--bc-samples K] [--bc-batch 16] [--topk 10]\n"
+         << "         --closeness [--closeness-samples K] [--closeness-out c.txt]\n"
+         << "         --diameter ifub|tk [--ecc-out ecc.txt]\n"
+         << "         --pll-build index.pll | --pll index.pll [--queries 10000]\n"
+         << "         --reach-build index.rch | --reach index.rch [--reach-labels 4] [--queries 10000]\n"
+         << "         --serve /tmp/bfs.sock|- [--serve-threads 4] [--pll index.pll] [--reach index.rch]\n"
+         << "           [--cache-mb 256] [--cache-admit 2]\n"
+         << "         --external graph.bin [--ext-mem-mb 256] [--io-threads 4] [--ext-cold] [--external-check]\n"
+         << "         --landmarks 16 [--landmark-select degree|random|farthest] [--queries 10000]\n";
 }
 
+// Command-line options shared by both binaries (defaults as documented above).
+struct Options {
+    int n = 10000;
+    int deg = 8;
+    int start = 0;
+    string file;
+    string ingest = "pipeline";  // --file loader: pipeline or stream
+    uint64_t seed = 42;
+    int iters = 1;
+    bool directed = false;
+    bool interleave = false;
+    bool numa_bench = false;
+    bool hugepages = false;
+    string engine = "level";
+    int64_t grain = 0;       // 0 = calibrate
+    string stats;            // per-level statistics output path
+    string stats_format = "json";
+    string trace;            // Chrome trace output path
+    bool perf = false;
+    bool teps = false;
+    int roots = 64;
+    string cc;               // connected components: "", bfs or afforest
+    string cc_out;
+    string scc;              // strongly connected components: "", fwbw or tarjan
+    string scc_out;
+    string scc_dag_out;
+    bool bc = false;         // betweenness centrality
+    int bc_samples = 0;      // 0 = exact (all sources)
+    int bc_batch = 16;
+    bool closeness = false;  // closeness/harmonic centrality
+    int closeness_samples = 0; // 0 = exact (all sources)
+    string closeness_out;
+    int topk = 10;
+    string diameter;         // "", ifub or tk
+    string ecc_out;
+    string pll_build;        // distance index to build and save
+    string pll;              // distance index to load
+    int queries = 10000;
+    string reach_build;      // reachability index to build and save
+    string reach;            // reachability index to load
+    int reach_labels = 4;
+    string serve;            // query server socket path, "-" for stdin
+    int serve_threads = 0;       // 0: OpenMP thread count
+    int cache_mb = 0;            // 0: no BFS result cache
+    int cache_admit = 2;
+    int landmarks = 0;           // 0: no landmark oracle
+    string landmark_select = "degree";
+    string external;         // semi-external BFS over this binary CSR file
+    int ext_mem_mb = 256;
+    int io_threads = 4;
+    bool ext_cold = false;
+    bool external_check = false;
+    string export_path;      // --export
+    string export_format = "el";
+};
+
 // Minimal CLI parser shared by both binaries.
-// Parses command-line arguments and sets default values.
-inline bool parse_args(int argc, char** argv, int& n, int& deg, int& start,
-                       string& file, uint64_t& seed, int& iters, bool& directed) {
-    n = 10000; deg = 8; start = 0; file = ""; seed = 42; iters = 1, directed = false; // set defaults
+// Parses command-line arguments on top of the defaults in Options.
+inline bool parse_args(int argc, char** argv, Options& opt) {
+    opt = Options(); // set defaults
 
     for (int i = 1; i < argc; ++i) {
         string a = argv[i];
         auto need = [&](int j){ return j + 1 < argc; };
-        if      (a == "--n"     && need(i)) n    = atoi(argv[++i]);
-        else if (a == "--deg"   && need(i)) deg  = atoi(argv[++i]);
-        else if (a == "--start" && need(i)) start= atoi(argv[++i]);
-        else if (a == "--file"  && need(i)) file = argv[++i];
-        else if (a == "--seed"  && need(i)) seed = strtoull(argv[++i], nullptr, 10);
-        else if (a == "--iters" && need(i)) iters = atoi(argv[++i]);
-        else if (a == "--directed") directed = true;
+        if      (a == "--n"     && need(i)) opt.n    = atoi(argv[++i]);
+        else if (a == "--deg"   && need(i)) opt.deg  = atoi(argv[++i]);
+        else if (a == "--start" && need(i)) opt.start= atoi(argv[++i]);
+        else if (a == "--file"  && need(i)) opt.file = argv[++i];
+        else if (a == "--ingest" && need(i)) opt.ingest = argv[++i];
+        else if (a == "--seed"  && need(i)) opt.seed = strtoull(argv[++i], nullptr, 10);
+        else if (a == "--iters" && need(i)) opt.iters = atoi(argv[++i]);
+        else if (a == "--directed")   opt.directed = true;
+        else if (a == "--interleave") opt.interleave = true;
+        else if (a == "--numa-bench") opt.numa_bench = true;
+        else if (a == "--hugepages")  opt.hugepages = true;
+        else if (a == "--engine" && need(i)) opt.engine = argv[++i];
+        else if (a == "--grain"  && need(i)) opt.grain = strtoll(argv[++i], nullptr, 10);
+        else if (a == "--stats"  && need(i)) opt.stats = argv[++i];
+        else if (a == "--stats-format" && need(i)) opt.stats_format = argv[++i];
+        else if (a == "--trace"  && need(i)) opt.trace = argv[++i];
+        else if (a == "--perf") opt.perf = true;
+        else if (a == "--teps") opt.teps = true;
+        else if (a == "--roots" && need(i)) opt.roots = atoi(argv[++i]);
+        else if (a == "--cc"     && need(i)) opt.cc = argv[++i];
+        else if (a == "--cc-out" && need(i)) opt.cc_out = argv[++i];
+        else if (a == "--scc"    && need(i)) opt.scc = argv[++i];
+        else if (a == "--scc-out" && need(i)) opt.scc_out = argv[++i];
+        else if (a == "--scc-dag-out" && need(i)) opt.scc_dag_out = argv[++i];
+        else if (a == "--bc") opt.bc = true;
+        else if (a == "--bc-samples" && need(i)) opt.bc_samples = atoi(argv[++i]);
+        else if (a == "--bc-batch"   && need(i)) opt.bc_batch = atoi(argv[++i]);
+        else if (a == "--closeness") opt.closeness = true;
+        else if (a == "--closeness-samples" && need(i)) opt.closeness_samples = atoi(argv[++i]);
+        else if (a == "--closeness-out" && need(i)) opt.closeness_out = argv[++i];
+        else if (a == "--topk" && need(i)) opt.topk = atoi(argv[++i]);
+        else if (a == "--diameter" && need(i)) opt.diameter = argv[++i];
+        else if (a == "--ecc-out"  && need(i)) opt.ecc_out = argv[++i];
+        else if (a == "--pll-build" && need(i)) opt.pll_build = argv[++i];
+        else if (a == "--pll"     && need(i)) opt.pll = argv[++i];
+        else if (a == "--queries" && need(i)) opt.queries = atoi(argv[++i]);
+        else if (a == "--reach-build" && need(i)) opt.reach_build = argv[++i];
+        else if (a == "--reach"   && need(i)) opt.reach = argv[++i];
+        else if (a == "--reach-labels" && need(i)) opt.reach_labels = atoi(argv[++i]);
+        else if (a == "--serve"   && need(i)) opt.serve = argv[++i];
+        else if (a == "--serve-threads" && need(i)) opt.serve_threads = atoi(argv[++i]);
+        else if (a == "--cache-mb" && need(i)) opt.cache_mb = atoi(argv[++i]);
+        else if (a == "--cache-admit" && need(i)) opt.cache_admit = atoi(argv[++i]);
+        else if (a == "--landmarks" && need(i)) opt.landmarks = atoi(argv[++i]);
+        else if (a == "--landmark-select" && need(i)) opt.landmark_select = argv[++i];
+        else if (a == "--external" && need(i)) opt.external = argv[++i];
+        else if (a == "--ext-mem-mb" && need(i)) opt.ext_mem_mb = atoi(argv[++i]);
+        else if (a == "--io-threads" && need(i)) opt.io_threads = atoi(argv[++i]);
+        else if (a == "--ext-cold") opt.ext_cold = true;
+        else if (a == "--external-check") opt.external_check = true;
+        else if (a == "--export" && need(i)) opt.export_path = argv[++i];
+        else if (a == "--format" && need(i)) opt.export_format = argv[++i];
         else { usage(argv[0]); return false; }
     }
 
-    if (n <= 0)                 { cerr << "Invalid --n\n"; return false; }
-    if (deg < 0)                { cerr << "Invalid --deg\n"; return false; }
-    if (start < 0 || start >= n){ cerr << "Invalid --start\n"; return false; }
-    if (iters <= 0) { cerr << "Invalid --iters\n"; return false; }
+    if (opt.n <= 0)                     { cerr << "Invalid --n\n"; return false; }
+    if (opt.deg < 0)                    { cerr << "Invalid --deg\n"; return false; }
+    // --external checks --start against the file
+    if (opt.start < 0 || (opt.external.empty() && opt.start >= opt.n)){ cerr << "Invalid --start\n"; return false; }
+    if (opt.iters <= 0) { cerr << "Invalid --iters\n"; return false; }
+    if (opt.ingest != "pipeline" && opt.ingest != "stream") { cerr << "Invalid --ingest\n"; return false; }
+    if (opt.grain < 0)  { cerr << "Invalid --grain\n"; return false; }
+    if (opt.roots <= 0) { cerr << "Invalid --roots\n"; return false; }
+    if (opt.stats_format != "json" && opt.stats_format != "csv")
+                        { cerr << "Invalid --stats-format\n"; return false; }
+    if (!opt.cc.empty() && opt.cc != "bfs" && opt.cc != "afforest")
+                        { cerr << "Invalid --cc\n"; return false; }
+    if (!opt.scc.empty() && opt.scc != "fwbw" && opt.scc != "tarjan")
+                        { cerr << "Invalid --scc\n"; return false; }
+    if ((!opt.scc_out.empty() || !opt.scc_dag_out.empty()) && opt.scc.empty())
+                        { cerr << "--scc-out/--scc-dag-out need --scc\n"; return false; }
+    if (opt.bc_samples < 0) { cerr << "Invalid --bc-samples\n"; return false; }
+    if (opt.bc_batch < 1 || opt.bc_batch > 64) { cerr << "Invalid --bc-batch\n"; return false; }
+    if (opt.closeness_samples < 0) { cerr << "Invalid --closeness-samples\n"; return false; }
+    if (opt.topk <= 0) { cerr << "Invalid --topk\n"; return false; }
+    if (!opt.diameter.empty() && opt.diameter != "ifub" && opt.diameter != "tk")
+                        { cerr << "Invalid --diameter\n"; return false; }
+    if (!opt.ecc_out.empty() && opt.diameter != "tk")
+                        { cerr << "--ecc-out needs --diameter tk\n"; return false; }
+    if (opt.queries <= 0) { cerr << "Invalid --queries\n"; return false; }
+    if (opt.reach_labels < 1 || opt.reach_labels > 16) { cerr << "Invalid --reach-labels\n"; return false; }
+    if (opt.serve_threads < 0) { cerr << "Invalid --serve-threads\n"; return false; }
+    if (opt.cache_mb < 0) { cerr << "Invalid --cache-mb\n"; return false; }
+    if (opt.cache_admit < 1 || opt.cache_admit > 254) { cerr << "Invalid --cache-admit\n"; return false; }
+    if (opt.landmarks < 0) { cerr << "Invalid --landmarks\n"; return false; }
+    if (opt.landmark_select != "degree" && opt.landmark_select != "random" && opt.landmark_select != "farthest")
+                        { cerr << "Invalid --landmark-select\n"; return false; }
+    if (opt.ext_mem_mb <= 0) { cerr << "Invalid --ext-mem-mb\n"; return false; }
+    if (opt.io_threads <= 0) { cerr << "Invalid --io-threads\n"; return false; }
+    if (opt.export_format != "el" && opt.export_format != "bin" && opt.export_format != "dot")
+                        { cerr << "Invalid --format\n"; return false; }
     return true;
 }
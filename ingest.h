@@ -0,0 +1,258 @@
+// ingest.h
+// -----------------------------------------------------------------------------
+// Pipelined edge-list loader (--file with --ingest pipeline, the default).
+// -----------------------------------------------------------------------------
+//
+// load_edgelist() (graph_utils.h) reads, then parses, then builds, one after
+// the other through an istream. Here the three stages overlap:
+//   read    --io-threads workers pread kIngestBlock-byte blocks into a ring
+//           of `depth` slots. A slot is reused only once its block has been
+//           parsed, so a fast disk stalls on the parsers (backpressure)
+//           instead of buffering the file.
+//   parse   one parser thread per OpenMP thread takes any completed block.
+//           A block is read with kIngestMaxLine bytes of the next one, and
+//           its parser handles exactly the lines that start inside it (the
+//           partial first line belongs to the previous block), so blocks
+//           parse independently and in any order.
+//   bucket  each parsed edge goes straight into the parser's bucket of its
+//           source range (kIngestRangeBits vertices; both directions, the
+//           graph is undirected). This is the degree-counting/scatter stage
+//           of build_csr, moved into the pipeline.
+// After the last block each range becomes its CSR rows in parallel: count,
+// prefix sum, scatter, sort and deduplicate inside a range-local array of
+// cache-resident size. No atomics are needed, because a range has one owner.
+//
+// The result is the graph load_edgelist() builds: undirected, rows sorted
+// and deduplicated, self-loops and out-of-range IDs dropped. Parsing is one
+// edge per line, "u v" separated by spaces or tabs, with anything after the
+// second number ignored; lines that do not start with two non-negative
+// integers (comments such as SNAP's "# ..." headers) are skipped.
+//
+// IngestStats tell which stage bounds the load: parsers starved for blocks
+// means the disk is the limit; readers blocked on a full ring means the
+// parsers are.
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <deque>
+#include <string>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include "graph_utils.h"
+#include "graph_io.h"
+#include "mem_utils.h"
+#include "phase_timer.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+using namespace std;
+
+constexpr size_t kIngestBlock = size_t(4) << 20;
+constexpr size_t kIngestMaxLine = 4096;      // longer lines at a block end are cut
+constexpr int kIngestRangeBits = 16;
+
+struct IngestStats {
+    int64_t bytes = 0, blocks = 0, edges = 0;  // edges: accepted lines
+    int io_threads = 0, parsers = 0, depth = 0;
+    double ingest_s = 0, build_s = 0;
+    double reader_blocked_s = 0;               // readers waiting for a free slot
+    double parser_starved_s = 0;               // parsers waiting for a block
+};
+
+// Calls emit(u, v) for every "u v" line that starts in [p, stop); lines may
+// run on to `end`. A line without its newline before `end` is dropped as cut
+// off unless `end` is the end of the file.
+template <class Emit>
+inline void ingest_parse(const char* p, const char* stop, const char* end, bool eof, Emit emit) {
+    while (p < stop) {
+        long long x[2];
+        int got = 0;
+        const char* q = p;
+        while (got < 2 && q < end) {
+            while (q < end && (*q == ' ' || *q == '\t')) ++q;
+            if (q == end || *q < '0' || *q > '9') break;
+            long long v = 0;
+            for (; q < end && *q >= '0' && *q <= '9'; ++q)
+                if (v <= INT_MAX) v = v * 10 + (*q - '0');
+            x[got++] = v;
+        }
+        const char* nl = q < end ? (const char*)memchr(q, '\n', (size_t)(end - q)) : nullptr;
+        if (got == 2 && (nl || eof)) emit(x[0], x[1]);
+        p = nl ? nl + 1 : end;
+    }
+}
+
+// Loads the undirected edge list at `path` over vertices [0, n) into g.
+// Returns false (with a message) if the file cannot be read.
+inline bool load_edgelist_pipelined(const string& path, int n, Graph& g, int io_threads,
+                                    bool interleave = false, IngestStats* stats = nullptr) {
+    IngestStats st;
+    const double t0 = phase_now();
+    InFile f;
+    if (!f.open(path)) { cerr << "Failed to open " << path << "\n"; return false; }
+    const uint64_t size = f.size();
+    const size_t blocks = (size_t)((size + kIngestBlock - 1) / kIngestBlock);
+    int P = 1;
+#ifdef _OPENMP
+    P = omp_get_max_threads();
+#endif
+    const int readers = max(1, min<int>(io_threads, (int)max<size_t>(blocks, 1)));
+    const int depth = 2 * P + readers;
+    const size_t slot_bytes = kIngestBlock + kIngestMaxLine + 1;
+    const int ranges = (int)(((int64_t)n + (1 << kIngestRangeBits) - 1) >> kIngestRangeBits);
+
+    // Ring of block buffers; slot s holds block ids s, s + depth, ...
+    page_vector<char> ring((size_t)depth * slot_bytes);
+    struct Slot { uint64_t start = 0; size_t len = 0; bool free = true; };
+    vector<Slot> slot(depth);
+    deque<size_t> ready;                        // blocks read, oldest first
+    size_t next_read = 0, done_read = 0;
+    bool failed = false;
+    mutex mu;
+    condition_variable cv;
+
+    auto reader = [&]() {
+        for (;;) {
+            size_t i;
+            double w = phase_now();
+            {
+                unique_lock<mutex> lk(mu);
+                cv.wait(lk, [&] { return failed || next_read >= blocks || slot[next_read % depth].free; });
+                if (failed || next_read >= blocks) return;
+                i = next_read++;
+                slot[i % depth].free = false;
+                st.reader_blocked_s += phase_now() - w;
+            }
+            // One byte of the previous block tells whether the first line is whole
+            Slot& s = slot[i % depth];
+            const uint64_t beg = i ? (uint64_t)i * kIngestBlock - 1 : 0;
+            const uint64_t end = min<uint64_t>(size, (uint64_t)(i + 1) * kIngestBlock + kIngestMaxLine);
+            char* buf = ring.data() + (i % depth) * slot_bytes;
+            const bool ok = f.read_at(buf, (size_t)(end - beg), beg);
+            lock_guard<mutex> lk(mu);
+            s.start = beg; s.len = (size_t)(end - beg);
+            if (!ok) failed = true;
+            ready.push_back(i);
+            done_read++;
+            cv.notify_all();
+        }
+    };
+
+    // buckets[t][r]: (u, v) entries with u in range r, from parser t
+    vector<vector<vector<pair<int, int>>>> buckets(P, vector<vector<pair<int, int>>>(ranges));
+    vector<int64_t> accepted(P, 0);
+    vector<double> starved(P, 0.0);
+    auto parser = [&](int t) {
+        vector<vector<pair<int, int>>>& out = buckets[t];
+        for (;;) {
+            size_t i;
+            const double w = phase_now();
+            {
+                unique_lock<mutex> lk(mu);
+                cv.wait(lk, [&] { return failed || !ready.empty() || done_read >= blocks; });
+                if (failed || ready.empty()) { starved[t] += phase_now() - w; return; }
+                i = ready.front(); ready.pop_front();
+            }
+            starved[t] += phase_now() - w;
+            const Slot& s = slot[i % depth];
+            const char* buf = ring.data() + (i % depth) * slot_bytes;
+            const char* end = buf + s.len;
+            const char* stop = min(end, buf + ((uint64_t)(i + 1) * kIngestBlock - s.start));
+            const char* p = buf;
+            if (i) {                            // skip to the first line starting in this block
+                const char* nl = (const char*)memchr(p, '\n', (size_t)(end - p));
+                p = nl ? nl + 1 : end;
+            }
+            ingest_parse(p, stop, end, s.start + s.len == size, [&](long long u, long long v) {
+                if (u >= n || v >= n || u == v) return;
+                out[u >> kIngestRangeBits].push_back({(int)u, (int)v});
+                out[v >> kIngestRangeBits].push_back({(int)v, (int)u});
+                accepted[t]++;
+            });
+            lock_guard<mutex> lk(mu);
+            slot[i % depth].free = true;
+            cv.notify_all();
+        }
+    };
+
+    vector<thread> pool;
+    for (int r = 0; r < readers; ++r) pool.emplace_back(reader);
+    for (int t = 0; t < P; ++t) pool.emplace_back(parser, t);
+    for (thread& th : pool) th.join();
+    if (failed) { cerr << "Failed to read " << path << "\n"; return false; }
+    ring = page_vector<char>();
+    for (int t = 0; t < P; ++t) { st.edges += accepted[t]; st.parser_starved_s += starved[t]; }
+    st.bytes = (int64_t)size; st.blocks = (int64_t)blocks;
+    st.io_threads = readers; st.parsers = P; st.depth = depth;
+    st.ingest_s = phase_now() - t0;
+    phase_timer().add("ingest", st.ingest_s, st.bytes, st.edges);
+
+    // Per range: rows into a range-local array, sorted and deduplicated;
+    // offsets[u + 1] gets the row length
+    const double t1 = phase_now();
+    g.offsets.resize((size_t)n + 1);
+    first_touch_fill(g.offsets.data(), g.offsets.size(), int64_t(0));
+    vector<vector<int>> rows(ranges);
+    BFS_OMP(omp parallel)
+    {
+        vector<int64_t> pos;
+        BFS_OMP(omp for schedule(dynamic, 1))
+        for (int r = 0; r < ranges; ++r) {
+            const int lo = r << kIngestRangeBits, hi = (int)min<int64_t>(n, (int64_t)(r + 1) << kIngestRangeBits);
+            pos.assign((size_t)(hi - lo) + 1, 0);
+            for (int t = 0; t < P; ++t)
+                for (const auto& e : buckets[t][r]) pos[e.first - lo + 1]++;
+            for (int u = lo; u < hi; ++u) pos[u - lo + 1] += pos[u - lo];
+            vector<int>& row = rows[r];
+            row.resize((size_t)pos[hi - lo]);
+            for (int t = 0; t < P; ++t) {
+                for (const auto& e : buckets[t][r]) row[pos[e.first - lo]++] = e.second;
+                vector<pair<int, int>>().swap(buckets[t][r]);
+            }
+            // pos[u - lo] is now the end of row u; compact the deduplicated rows
+            int64_t w = 0, b = 0;
+            for (int u = lo; u < hi; ++u) {
+                const int64_t e = pos[u - lo];
+                sort(row.begin() + b, row.begin() + e);
+                const int64_t len = unique(row.begin() + b, row.begin() + e) - (row.begin() + b);
+                copy(row.begin() + b, row.begin() + b + len, row.begin() + w);
+                g.offsets[u + 1] = len;
+                w += len; b = e;
+            }
+            row.resize((size_t)w);
+        }
+    }
+    for (int u = 0; u < n; ++u) g.offsets[u + 1] += g.offsets[u];
+    g.adj.resize((size_t)g.offsets[n]);
+    if (interleave) numa_interleave(g.adj.data(), g.adj.size() * sizeof(int));
+    BFS_OMP(omp parallel for schedule(dynamic, 1))
+    for (int r = 0; r < ranges; ++r) {
+        copy(rows[r].begin(), rows[r].end(), g.adj.data() + g.offsets[(int64_t)r << kIngestRangeBits]);
+        vector<int>().swap(rows[r]);
+    }
+    st.build_s = phase_now() - t1;
+    phase_timer().add("csr_build", st.build_s, 0, st.edges);
+    if (stats) *stats = st;
+    return true;
+}
+
+// One line summary of a pipelined load.
+inline void print_ingest(ostream& out, const IngestStats& st) {
+    const ios::fmtflags flags = out.flags();
+    const streamsize prec = out.precision();
+    out << fixed << setprecision(3)
+        << "Ingest_blocks=" << st.blocks << " Ingest_io_threads=" << st.io_threads
+        << " Ingest_parsers=" << st.parsers << " Ingest_depth=" << st.depth
+        << " Ingest_MBps=" << setprecision(1) << st.bytes / max(st.ingest_s, 1e-9) / 1e6
+        << setprecision(3) << " Ingest_reader_blocked_s=" << st.reader_blocked_s
+        << " Ingest_parser_starved_s=" << st.parser_starved_s
+        << " Ingest_bound=" << (st.parser_starved_s > st.reader_blocked_s ? "read" : "parse") << "\n";
+    out.flags(flags);
+    out.precision(prec);
+}
@@ -0,0 +1,210 @@
+// landmarks.h
+// -----------------------------------------------------------------------------
+// Approximate distance oracle from K landmarks (bfs_par --landmarks K).
+// -----------------------------------------------------------------------------
+//
+// A BFS from each landmark L stores d(L, v) for every v (and, for directed
+// graphs, a BFS over the reversed edges stores d(v, L)). The triangle
+// inequality then bounds any distance in O(K):
+//   upper  d(s, t) <= min over L of d(s, L) + d(L, t)
+//   lower  d(s, t) >= max over L of d(L, t) - d(L, s) and d(s, L) - d(t, L)
+// Undirected graphs have one array and the lower bound is |d(L, s) - d(L, t)|.
+// A landmark that reaches s but not t (or reaches from t but not from s)
+// proves t unreachable from s. Unlike pll.h the build is K BFS runs, so it
+// scales to any graph the BFS itself handles; the bounds are exact only where
+// a landmark lies on a shortest path.
+//
+// Landmark selection (--landmark-select):
+//   degree    the K highest-degree vertices (hubs sit on many shortest paths)
+//   random    K random non-isolated vertices (--seed)
+//   farthest  farthest-first: the highest-degree vertex, then repeatedly the
+//             vertex farthest from all landmarks so far (unreached vertices,
+//             i.e. other components, first). Needs the BFS of each landmark
+//             before picking the next, so it runs bfs_openmp_level one at a
+//             time; degree and random run msbfs_batch (closeness.h), 64
+//             landmarks per sweep, sweeps spread over the threads.
+//
+// Layout: distances are uint8 (kLmInf = unreachable; graphs with a distance
+// over 254 are rejected), vertex-major with the K landmarks of a vertex
+// padded to kLmLanes with kLmInf, so a query reads two (four when directed)
+// contiguous rows and reduces them 16 lanes at a time with SSE2 saturating
+// add/subtract and unsigned min/max. The kLmInf padding is neutral in all
+// three reductions.
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+#include <climits>
+#include <cstdint>
+#include "graph_utils.h"
+#include "mem_utils.h"
+#include "bfs_kernels.h"
+#include "closeness.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+using namespace std;
+
+constexpr uint8_t kLmInf = 255;
+constexpr int kLmLanes = 16;
+
+struct LandmarkOracle {
+    int n = 0, k = 0;
+    int stride = 0;                  // k rounded up to kLmLanes
+    bool directed = false;
+    vector<int> landmarks;
+    page_vector<uint8_t> from;       // [v * stride + i] = d(landmark i, v)
+    page_vector<uint8_t> to;         // d(v, landmark i); empty when undirected
+
+    const uint8_t* from_row(int v) const { return from.data() + (size_t)v * stride; }
+    const uint8_t* to_row(int v) const { return (directed ? to.data() : from.data()) + (size_t)v * stride; }
+    size_t bytes() const { return bytes_of(from) + bytes_of(to); }
+};
+
+struct LmBounds {
+    int lo = 0;
+    int hi = -1;                     // -1: no landmark connects s to t
+    bool unreachable = false;        // proven: no path s -> t
+};
+
+// Distance bounds for s -> t.
+inline LmBounds lm_bounds(const LandmarkOracle& o, int s, int t) {
+    LmBounds b;
+    if (s == t) { b.hi = 0; return b; }
+    const uint8_t* fs = o.from_row(s); const uint8_t* ft = o.from_row(t);
+    const uint8_t* ts = o.to_row(s);   const uint8_t* tt = o.to_row(t);
+    int lo = 0, hi = kLmInf;
+    bool bad = false;
+#ifdef __SSE2__
+    const __m128i inf = _mm_set1_epi8((char)kLmInf);
+    __m128i vlo = _mm_setzero_si128(), vhi = inf, vbad = _mm_setzero_si128();
+    for (int i = 0; i < o.stride; i += kLmLanes) {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(fs + i));   // d(L, s)
+        const __m128i b = _mm_loadu_si128((const __m128i*)(ft + i));   // d(L, t)
+        const __m128i c = _mm_loadu_si128((const __m128i*)(ts + i));   // d(s, L)
+        const __m128i d = _mm_loadu_si128((const __m128i*)(tt + i));   // d(t, L)
+        vhi = _mm_min_epu8(vhi, _mm_adds_epu8(c, b));
+        vlo = _mm_max_epu8(vlo, _mm_max_epu8(_mm_subs_epu8(b, a), _mm_subs_epu8(c, d)));
+        vbad = _mm_or_si128(vbad, _mm_andnot_si128(_mm_cmpeq_epi8(a, inf), _mm_cmpeq_epi8(b, inf)));
+        vbad = _mm_or_si128(vbad, _mm_andnot_si128(_mm_cmpeq_epi8(d, inf), _mm_cmpeq_epi8(c, inf)));
+    }
+    // Horizontal reductions: fold the upper half onto the lower one, 4 times
+    vhi = _mm_min_epu8(vhi, _mm_srli_si128(vhi, 8)); vlo = _mm_max_epu8(vlo, _mm_srli_si128(vlo, 8));
+    vhi = _mm_min_epu8(vhi, _mm_srli_si128(vhi, 4)); vlo = _mm_max_epu8(vlo, _mm_srli_si128(vlo, 4));
+    vhi = _mm_min_epu8(vhi, _mm_srli_si128(vhi, 2)); vlo = _mm_max_epu8(vlo, _mm_srli_si128(vlo, 2));
+    vhi = _mm_min_epu8(vhi, _mm_srli_si128(vhi, 1)); vlo = _mm_max_epu8(vlo, _mm_srli_si128(vlo, 1));
+    hi = _mm_cvtsi128_si32(vhi) & 0xff;
+    lo = _mm_cvtsi128_si32(vlo) & 0xff;
+    bad = _mm_movemask_epi8(vbad) != 0;
+#else
+    for (int i = 0; i < o.k; ++i) {
+        hi = min(hi, ts[i] + ft[i]);
+        lo = max(lo, max(ft[i] - fs[i], ts[i] - tt[i]));
+        bad = bad || (ft[i] == kLmInf && fs[i] != kLmInf) || (ts[i] == kLmInf && tt[i] != kLmInf);
+    }
+#endif
+    b.unreachable = bad;
+    b.lo = lo;
+    b.hi = hi >= kLmInf ? -1 : hi;
+    return b;
+}
+
+// Picks the landmarks (degree or random; farthest is picked during the build).
+inline vector<int> lm_select(const Graph& g, const Graph& rev, int k, const string& how, uint64_t seed) {
+    vector<int> cand;
+    for (int u = 0; u < g.size(); ++u) if (g.degree(u) + rev.degree(u) > 0) cand.push_back(u);
+    if (how == "random") {
+        mt19937_64 rng(seed);
+        shuffle(cand.begin(), cand.end(), rng);
+    } else {
+        stable_sort(cand.begin(), cand.end(), [&](int a, int b) {
+            return g.degree(a) + rev.degree(a) > g.degree(b) + rev.degree(b);
+        });
+    }
+    if ((int)cand.size() > k) cand.resize(k);
+    return cand;
+}
+
+// Column i of `d` from a BFS level array; false when a level exceeds 254.
+inline bool lm_store(page_vector<uint8_t>& d, int stride, int i, const page_vector<int>& level) {
+    bool ok = true;
+    for (size_t v = 0; v < level.size(); ++v) {
+        const int l = level[v];
+        if (l < 0) continue;
+        if (l >= kLmInf) ok = false;
+        else d[v * stride + i] = (uint8_t)l;
+    }
+    return ok;
+}
+
+// Builds the oracle over g (`rev` = reversed edges, g itself when undirected)
+// with up to k landmarks chosen by `how` (degree, random or farthest). Returns
+// false (with a message) when a distance does not fit in 8 bits.
+inline bool lm_build(const Graph& g, const Graph& rev, bool directed, int k, const string& how,
+                     uint64_t seed, LandmarkOracle& o) {
+    const int n = g.size();
+    o.n = n; o.directed = directed;
+    o.stride = (k + kLmLanes - 1) / kLmLanes * kLmLanes;
+    o.from.resize((size_t)n * o.stride);
+    first_touch_fill(o.from.data(), o.from.size(), kLmInf);
+    if (directed) {
+        o.to.resize((size_t)n * o.stride);
+        first_touch_fill(o.to.data(), o.to.size(), kLmInf);
+    }
+    bool ok = true;
+
+    if (how == "farthest") {
+        // mind[v] = min over the landmarks so far of d(L, v); INT_MAX unreached
+        vector<int> mind(n, INT_MAX);
+        page_vector<int> level;
+        const vector<int> first = lm_select(g, rev, 1, "degree", seed);
+        int next = first.empty() ? -1 : first[0];
+        for (int i = 0; i < k && next >= 0; ++i) {
+            o.landmarks.push_back(next);
+            bfs_openmp_level(g, next, &level);
+            ok = lm_store(o.from, o.stride, i, level) && ok;
+            for (int v = 0; v < n; ++v) if (level[v] >= 0) mind[v] = min(mind[v], level[v]);
+            if (directed) {
+                bfs_openmp_level(rev, next, &level);
+                ok = lm_store(o.to, o.stride, i, level) && ok;
+            }
+            next = -1;
+            for (int v = 0; v < n; ++v) {
+                if (mind[v] == 0 || g.degree(v) + rev.degree(v) == 0) continue;
+                if (next < 0 || mind[v] > mind[next] ||
+                    (mind[v] == mind[next] && g.degree(v) > g.degree(next))) next = v;
+            }
+        }
+    } else {
+        o.landmarks = lm_select(g, rev, k, how, seed);
+        const int K = (int)o.landmarks.size();
+        const int batches = (K + 63) / 64;
+        const int dirs = directed ? 2 : 1;
+        #pragma omp parallel
+        {
+            MsBfsScratch s(n);
+            #pragma omp for schedule(dynamic, 1) collapse(2) reduction(&&:ok)
+            for (int b = 0; b < batches; ++b)
+                for (int dir = 0; dir < dirs; ++dir) {
+                    const int base = b * 64, cnt = min(64, K - base);
+                    page_vector<uint8_t>& d = dir == 0 ? o.from : o.to;
+                    for (int j = 0; j < cnt; ++j) d[(size_t)o.landmarks[base + j] * o.stride + base + j] = 0;
+                    msbfs_batch(dir == 0 ? g : rev, dir == 0 ? rev : g, o.landmarks.data() + base, cnt, s,
+                                [&](int lvl, int w, uint64_t mask) {
+                        if (lvl >= kLmInf) { ok = false; return; }
+                        uint8_t* row = d.data() + (size_t)w * o.stride + base;
+                        for (; mask; mask &= mask - 1) row[__builtin_ctzll(mask)] = (uint8_t)lvl;
+                    });
+                }
+        }
+    }
+    o.k = (int)o.landmarks.size();
+    if (!ok) cerr << "Distance over " << (kLmInf - 1) << " does not fit the 8-bit landmark distances\n";
+    return ok;
+}
@@ -0,0 +1,382 @@
+// mem_utils.h
+// -----------------------------------------------------------------------------
+// Memory placement helpers for the large arrays used by the BFS engines
+// (CSR offsets/neighbors, visited, level).
+// -----------------------------------------------------------------------------
+//
+// Linux places a page on the NUMA node of the thread that first writes it
+// ("first touch"). std::vector value-initializes its elements on the calling
+// thread, so every page of a big vector ends up on the master thread's node.
+// PageAllocator avoids that: construct() without arguments default-initializes,
+// which for ints/chars/atomics writes nothing, so the pages stay untouched until
+// a parallel loop with the same static schedule as the traversal fills them.
+//
+//   page_vector<int> level(n);           // NOT zeroed, pages untouched
+//   first_touch_fill(level.data(), n, -1);
+//
+// Freed regions are parked in a small cache and handed back to the next
+// allocation of the same size, so repeated BFS runs do not pay the page faults
+// again; reused pages keep the node placement of their original first touch.
+//
+// NUMA helpers (Linux only, no libnuma needed; no-ops elsewhere):
+//   numa_online_nodes()     node IDs from /sys/devices/system/node/online
+//   numa_current_node()     node of the calling thread (getcpu)
+//   numa_interleave(p, b)   round-robin the untouched pages of [p, p+b)
+//   numa_page_node(p)       node that currently holds the page of p (-1 = n/a)
+//
+// Huge pages (Linux, --hugepages): with mem_policy().hugepages set, allocations
+// of 2 MiB or more are backed by 2 MiB pages to cut dTLB misses on the random
+// g[u] / visited[v] accesses. MAP_HUGETLB is tried first (needs a reserved pool,
+// vm.nr_hugepages); otherwise the region is 2 MiB aligned and marked
+// madvise(MADV_HUGEPAGE) for transparent huge pages. huge_page_report() tells
+// how much of the mapped memory actually ended up on huge pages.
+//
+// Footprint (all platforms; RSS needs Linux or another Unix): bytes_of(v) is
+// the reserved size of a container, mem_footprint() collects it per data
+// structure of the last traversal, peak_rss_bytes() reads VmHWM (getrusage as
+// a fallback).
+//
+// Thread pinning is left to the OpenMP runtime; on multi-socket machines run
+// with OMP_PROC_BIND=spread OMP_PLACES=cores so that a thread keeps using the
+// pages it touched first.
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cctype>
+#include <fstream>
+#include <new>
+#include <utility>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <ostream>
+#include <cstring>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+// OpenMP pragma for the headers the sequential driver shares: expands to
+// nothing without -fopenmp, so that build has no unknown-pragma warnings.
+#ifdef _OPENMP
+#define BFS_OMP(...) _Pragma(#__VA_ARGS__)
+#else
+#define BFS_OMP(...)
+#endif
+
+// Allocations at least this large are mmap'ed directly (page aligned and
+// untouched); smaller ones go through operator new.
+constexpr size_t kPageAllocMin = size_t(1) << 20;
+constexpr size_t kHugePage = size_t(2) << 20;
+constexpr size_t kPageCacheSlots = 16; // freed regions kept for reuse
+
+// Process-wide allocation policy, set once by the driver before building.
+struct MemPolicy {
+    bool hugepages = false;
+};
+inline MemPolicy& mem_policy() { static MemPolicy p; return p; }
+
+// One mmap'ed region handed out by page_alloc().
+struct PageRegion {
+    size_t length = 0;     // mapped length (rounded up for huge pages)
+    bool huge = false;     // allocated under mem_policy().hugepages
+    bool hugetlb = false;  // backed by the MAP_HUGETLB pool
+};
+
+// Live page_alloc() regions, keyed by start address, plus freed regions
+// waiting for reuse (oldest first).
+struct PageRegistry {
+    mutex mu;
+    map<uintptr_t, PageRegion> regions;
+    vector<pair<uintptr_t, PageRegion>> cached;
+};
+inline PageRegistry& page_registry() { static PageRegistry r; return r; }
+
+#ifdef __linux__
+// 2 MiB aligned anonymous mapping of `len` bytes (a multiple of kHugePage).
+inline void* mmap_huge(size_t len, bool& hugetlb) {
+    void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) { hugetlb = true; return p; }
+
+    // No hugetlb pool: over-allocate, trim to 2 MiB alignment, ask for THP
+    hugetlb = false;
+    char* raw = (char*)mmap(nullptr, len + kHugePage, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return nullptr;
+    char* al = (char*)(((uintptr_t)raw + kHugePage - 1) & ~(uintptr_t)(kHugePage - 1));
+    if (al > raw) munmap(raw, al - raw);
+    size_t tail = (raw + len + kHugePage) - (al + len);
+    if (tail) munmap(al + len, tail);
+    madvise(al, len, MADV_HUGEPAGE);
+    return al;
+}
+#endif
+
+inline void* page_alloc(size_t bytes) {
+#ifdef __linux__
+    if (bytes >= kPageAllocMin) {
+        PageRegistry& reg = page_registry();
+        PageRegion r;
+        r.huge = mem_policy().hugepages && bytes >= kHugePage;
+        r.length = r.huge ? (bytes + kHugePage - 1) & ~(kHugePage - 1) : bytes;
+        {
+            lock_guard<mutex> lk(reg.mu);
+            for (size_t i = reg.cached.size(); i-- > 0; ) {
+                const PageRegion& c = reg.cached[i].second;
+                if (c.length == r.length && c.huge == r.huge) {
+                    uintptr_t a = reg.cached[i].first;
+                    reg.regions[a] = c;
+                    reg.cached.erase(reg.cached.begin() + i);
+                    return (void*)a;
+                }
+            }
+        }
+        void* p = nullptr;
+        if (r.huge) {
+            p = mmap_huge(r.length, r.hugetlb);
+        } else {
+            r.length = bytes;
+            p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) p = nullptr;
+        }
+        if (!p) throw bad_alloc();
+        lock_guard<mutex> lk(reg.mu);
+        reg.regions[(uintptr_t)p] = r;
+        return p;
+    }
+#endif
+    return ::operator new(bytes);
+}
+
+inline void page_free(void* p, size_t bytes) {
+#ifdef __linux__
+    if (bytes >= kPageAllocMin) {
+        PageRegistry& reg = page_registry();
+        lock_guard<mutex> lk(reg.mu);
+        auto it = reg.regions.find((uintptr_t)p);
+        if (it == reg.regions.end()) { munmap(p, bytes); return; }
+        if (reg.cached.size() == kPageCacheSlots) {
+            munmap((void*)reg.cached.front().first, reg.cached.front().second.length);
+            reg.cached.erase(reg.cached.begin());
+        }
+        reg.cached.push_back(*it);
+        reg.regions.erase(it);
+        return;
+    }
+#endif
+    (void)bytes;
+    ::operator delete(p);
+}
+
+// How much of the live page_alloc() memory sits on 2 MiB pages. THP coverage
+// comes from AnonHugePages in /proc/self/smaps; hugetlb regions count fully.
+struct HugePageReport {
+    size_t mapped_bytes = 0;  // all live page_alloc() regions
+    size_t huge_bytes = 0;    // of which backed by 2 MiB pages
+    size_t hugetlb_bytes = 0; // of which from the MAP_HUGETLB pool
+};
+
+inline HugePageReport huge_page_report() {
+    HugePageReport rep;
+    PageRegistry& reg = page_registry();
+    lock_guard<mutex> lk(reg.mu);
+    for (auto& kv : reg.regions) {
+        rep.mapped_bytes += kv.second.length;
+        if (kv.second.hugetlb) rep.hugetlb_bytes += kv.second.length;
+    }
+    rep.huge_bytes = rep.hugetlb_bytes;
+#ifdef __linux__
+    // The kernel may merge neighbouring regions into one VMA, so each VMA's
+    // AnonHugePages is capped by how much of it overlaps our regions.
+    ifstream in("/proc/self/smaps");
+    string line;
+    size_t overlap = 0;
+    auto is_vma_header = [](const string& l) {
+        size_t d = l.find('-');
+        if (d == 0 || d == string::npos || d > l.find(' ')) return false;
+        for (size_t i = 0; i < d; ++i)
+            if (!isxdigit((unsigned char)l[i])) return false;
+        return true;
+    };
+    while (getline(in, line)) {
+        unsigned long lo, hi;
+        char dash;
+        if (is_vma_header(line)) {
+            istringstream hs(line);
+            hs >> hex >> lo >> dash >> hi;
+            overlap = 0;
+            for (auto& kv : reg.regions) {
+                if (kv.second.hugetlb) continue;
+                uintptr_t a = max<uintptr_t>(kv.first, lo);
+                uintptr_t b = min<uintptr_t>(kv.first + kv.second.length, hi);
+                if (b > a) overlap += b - a;
+            }
+        } else if (overlap && line.compare(0, 14, "AnonHugePages:") == 0) {
+            size_t kb = strtoull(line.c_str() + 14, nullptr, 10);
+            rep.huge_bytes += min(kb * 1024, overlap);
+        }
+    }
+#endif
+    return rep;
+}
+
+// Allocator that leaves freshly allocated pages untouched (see header comment).
+template <class T>
+struct PageAllocator {
+    using value_type = T;
+
+    PageAllocator() = default;
+    template <class U> PageAllocator(const PageAllocator<U>&) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(page_alloc(n * sizeof(T))); }
+    void deallocate(T* p, size_t n) { page_free(p, n * sizeof(T)); }
+
+    // Default-initialize instead of value-initialize: no store, no first touch.
+    template <class U> void construct(U* p) { ::new ((void*)p) U; }
+    template <class U, class... Args> void construct(U* p, Args&&... args) {
+        ::new ((void*)p) U(std::forward<Args>(args)...);
+    }
+};
+template <class T, class U>
+bool operator==(const PageAllocator<T>&, const PageAllocator<U>&) { return true; }
+template <class T, class U>
+bool operator!=(const PageAllocator<T>&, const PageAllocator<U>&) { return false; }
+
+template <class T> using page_vector = vector<T, PageAllocator<T>>;
+
+// Fill p[0..n) with a static schedule so each thread first-touches the block of
+// indices it also owns during traversal.
+template <class T, class V>
+inline void first_touch_fill(T* p, size_t n, const V& value) {
+    BFS_OMP(omp parallel for schedule(static))
+    for (int64_t i = 0; i < (int64_t)n; ++i) p[i] = value;
+}
+
+// Online NUMA node IDs (e.g. "0-1" or "0,2-3"). Always at least {0}.
+inline vector<int> numa_online_nodes() {
+    vector<int> nodes;
+#ifdef __linux__
+    ifstream in("/sys/devices/system/node/online");
+    string s;
+    if (in >> s) {
+        size_t i = 0;
+        while (i < s.size()) {
+            size_t j = s.find(',', i);
+            if (j == string::npos) j = s.size();
+            string r = s.substr(i, j - i);
+            size_t d = r.find('-');
+            int lo = atoi(r.c_str());
+            int hi = (d == string::npos) ? lo : atoi(r.c_str() + d + 1);
+            for (int k = lo; k <= hi; ++k) nodes.push_back(k);
+            i = j + 1;
+        }
+    }
+#endif
+    if (nodes.empty()) nodes.push_back(0);
+    return nodes;
+}
+
+// NUMA node of the CPU the calling thread is running on (0 if unknown).
+inline int numa_current_node() {
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) return (int)node;
+#endif
+    return 0;
+}
+
+// Interleave the pages of [p, p+bytes) round-robin over all online nodes.
+// Must be called before the pages are touched. Returns false if the policy
+// was not applied (single node, non-Linux, or the kernel refused).
+inline bool numa_interleave(void* p, size_t bytes) {
+#if defined(__linux__) && defined(SYS_mbind)
+    vector<int> nodes = numa_online_nodes();
+    if (nodes.size() < 2 || bytes == 0) return false;
+    const uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t lo = ((uintptr_t)p + page - 1) & ~(page - 1);
+    uintptr_t hi = ((uintptr_t)p + bytes) & ~(page - 1);
+    if (hi <= lo) return false;
+    unsigned long mask[16] = {0};
+    for (int nd : nodes)
+        if (nd < 16 * 64) mask[nd / 64] |= 1UL << (nd % 64);
+    const int kMpolInterleave = 3;  // MPOL_INTERLEAVE from <numaif.h>
+    return syscall(SYS_mbind, lo, hi - lo, kMpolInterleave, mask,
+                   sizeof(mask) * 8, 0) == 0;
+#else
+    (void)p; (void)bytes;
+    return false;
+#endif
+}
+
+// Node currently backing the page that contains p, or -1 if unknown/not yet
+// faulted in.
+inline int numa_page_node(const void* p) {
+#if defined(__linux__) && defined(SYS_move_pages)
+    const uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    void* pages[1] = { (void*)((uintptr_t)p & ~(page - 1)) };
+    int status[1] = { -1 };
+    if (syscall(SYS_move_pages, 0, 1UL, pages, nullptr, status, 0) == 0 && status[0] >= 0)
+        return status[0];
+#endif
+    (void)p;
+    return -1;
+}
+
+// Reserved bytes of a vector / page_vector (capacity, not size).
+template <class V>
+inline size_t bytes_of(const V& v) { return v.capacity() * sizeof(typename V::value_type); }
+
+// Byte footprint of the major data structures of a traversal, by name. The
+// traversals record theirs when they finish; add() keeps the largest value per
+// name, so repeated runs report the peak. The driver clears it between phases.
+struct Footprint {
+    vector<pair<const char*, size_t>> items;
+
+    void clear() { items.clear(); }
+    void add(const char* name, size_t bytes) {
+        for (auto& it : items)
+            if (strcmp(it.first, name) == 0) { it.second = max(it.second, bytes); return; }
+        items.push_back({name, bytes});
+    }
+    size_t total() const { size_t t = 0; for (auto& it : items) t += it.second; return t; }
+
+    // "Mem_<tag>_<name>_bytes=... Mem_<tag>_total_bytes=..." on one line
+    void print(ostream& out, const string& tag) const {
+        for (auto& it : items) out << "Mem_" << tag << "_" << it.first << "_bytes=" << it.second << " ";
+        out << "Mem_" << tag << "_total_bytes=" << total() << "\n";
+    }
+};
+inline Footprint& mem_footprint() { static Footprint f; return f; }
+
+// Peak resident set size of the process so far (0 if unknown).
+inline size_t peak_rss_bytes() {
+#ifdef __linux__
+    ifstream in("/proc/self/status");
+    string line;
+    while (getline(in, line))
+        if (line.compare(0, 6, "VmHWM:") == 0) return strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+    rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0) {
+    #ifdef __APPLE__
+        return (size_t)ru.ru_maxrss;        // bytes
+    #else
+        return (size_t)ru.ru_maxrss * 1024; // kilobytes
+    #endif
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,198 @@
+// perf_counters.h
+// -----------------------------------------------------------------------------
+// Hardware performance counters through Linux perf_event_open (no perf tool or
+// library needed). Used by bfs_par --perf.
+// -----------------------------------------------------------------------------
+//
+// Every OpenMP thread opens one event group that counts its own user-space
+// cycles, instructions, LLC read misses, dTLB read misses and branch misses.
+// The groups stay open and free-running; read() sums all threads, so the cost
+// of a phase is the difference of two reads taken around it:
+//
+//   PerfCounters& pc = perf_counters();
+//   pc.open();                      // once, before the phases of interest
+//   PerfSample a = pc.read();  ...  PerfSample d = pc.read() - a;
+//
+// Events the CPU or kernel does not support are reported as n/a; when none can
+// be opened (non-Linux, VMs without a PMU, perf_event_paranoid > 2) available()
+// is false and the reason is kept in error(). Counts are scaled by
+// time_enabled / time_running when the kernel multiplexes the PMU.
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <ostream>
+#include <iomanip>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+using namespace std;
+
+enum PerfEvent { kCycles, kInstructions, kLlcMisses, kDtlbMisses, kBranchMisses, kPerfEvents };
+
+static const char* const kPerfEventNames[kPerfEvents] = {
+    "cycles", "instructions", "llc_misses", "dtlb_misses", "branch_misses"
+};
+
+// Counter values summed over threads; valid[e] is false for unsupported events.
+struct PerfSample {
+    uint64_t v[kPerfEvents] = {0, 0, 0, 0, 0};
+    bool valid[kPerfEvents] = {false, false, false, false, false};
+
+    PerfSample operator-(const PerfSample& o) const {
+        PerfSample d;
+        for (int e = 0; e < kPerfEvents; ++e) {
+            d.valid[e] = valid[e];
+            d.v[e] = v[e] >= o.v[e] ? v[e] - o.v[e] : 0;
+        }
+        return d;
+    }
+    PerfSample& operator+=(const PerfSample& o) {
+        for (int e = 0; e < kPerfEvents; ++e) { v[e] += o.v[e]; valid[e] = valid[e] || o.valid[e]; }
+        return *this;
+    }
+
+    // "cycles=... instructions=... IPC=... llc_misses=... dtlb_misses=... branch_misses=..."
+    void print(ostream& out) const {
+        const ios::fmtflags flags = out.flags();
+        const streamsize prec = out.precision();
+        for (int e = 0; e < kPerfEvents; ++e) {
+            out << (e ? " " : "") << kPerfEventNames[e] << '=';
+            if (valid[e]) out << v[e]; else out << "n/a";
+            if (e == kInstructions) {
+                out << " IPC=";
+                if (valid[kCycles] && valid[kInstructions] && v[kCycles])
+                    out << fixed << setprecision(3) << (double)v[kInstructions] / v[kCycles];
+                else out << "n/a";
+            }
+        }
+        out.flags(flags);
+        out.precision(prec);
+    }
+};
+
+class PerfCounters {
+public:
+    PerfCounters() = default;
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    ~PerfCounters() {
+#ifdef __linux__
+        for (const Group& g : groups_)
+            for (int fd : g.fds) close(fd);
+#endif
+    }
+
+    // Open one group per OpenMP thread. Returns available().
+    bool open() {
+#ifdef __linux__
+        if (!groups_.empty()) return available();
+        int P = 1;
+        #ifdef _OPENMP
+        P = omp_get_max_threads();
+        #endif
+        groups_.assign(P, Group());
+        #pragma omp parallel num_threads(P)
+        {
+            int t = 0;
+            #ifdef _OPENMP
+            t = omp_get_thread_num();
+            #endif
+            open_group(groups_[t]);
+        }
+        for (const Group& g : groups_)
+            if (g.leader >= 0) { available_ = true; break; }
+        if (!available_ && error_.empty()) error_ = "no events could be opened";
+#else
+        error_ = "perf_event_open is Linux-only";
+#endif
+        return available_;
+    }
+
+    bool available() const { return available_; }
+    const string& error() const { return error_; }
+
+    // Current totals over all threads.
+    PerfSample read() const {
+        PerfSample s;
+#ifdef __linux__
+        for (const Group& g : groups_) {
+            if (g.leader < 0) continue;
+            uint64_t buf[3 + kPerfEvents] = {0};
+            if (::read(g.leader, buf, sizeof(buf)) <= 0) continue;
+            const uint64_t nr = buf[0], enabled = buf[1], running = buf[2];
+            const double scale = (running > 0 && running < enabled) ? (double)enabled / running : 1.0;
+            for (uint64_t i = 0; i < nr && i < g.events.size(); ++i) {
+                int e = g.events[i];
+                s.v[e] += (uint64_t)(buf[3 + i] * scale);
+                s.valid[e] = true;
+            }
+        }
+#endif
+        return s;
+    }
+
+    // Per-level deltas of the most recent bfs_openmp_level run.
+    vector<PerfSample> levels;
+
+private:
+    struct Group {
+        int leader = -1;
+        vector<int> fds;
+        vector<int> events; // PerfEvent of each group member, in read order
+    };
+
+#ifdef __linux__
+    void open_group(Group& g) {
+        static const uint32_t types[kPerfEvents] = {
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+            PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE };
+        static const uint64_t configs[kPerfEvents] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_BRANCH_MISSES };
+
+        for (int e = 0; e < kPerfEvents; ++e) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[e];
+            attr.config = configs[e];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                               PERF_FORMAT_TOTAL_TIME_RUNNING;
+            int fd = (int)syscall(SYS_perf_event_open, &attr, 0 /*this thread*/, -1,
+                                  g.leader, 0);
+            if (fd < 0) {
+                #pragma omp critical(perf_error)
+                if (error_.empty()) error_ = string("perf_event_open: ") + strerror(errno);
+                continue;
+            }
+            if (g.leader < 0) g.leader = fd;
+            g.fds.push_back(fd);
+            g.events.push_back(e);
+        }
+    }
+#endif
+
+    vector<Group> groups_;
+    bool available_ = false;
+    string error_;
+};
+
+inline PerfCounters& perf_counters() { static PerfCounters pc; return pc; }
@@ -0,0 +1,86 @@
+// phase_timer.h
+// -----------------------------------------------------------------------------
+// End-to-end phase timing for both drivers: how long each phase of a run took
+// and at what throughput, so that the untimed work around the BFS (parsing,
+// building the CSR, exporting) shows up next to it.
+// -----------------------------------------------------------------------------
+//
+// Phases record themselves with the amount of work they did:
+//
+//   double t = phase_now();
+//   ... parse ...
+//   phase_timer().add("parse", phase_now() - t, bytes_read, edges_read);
+//
+// Repeated phases (e.g. BFS iterations) accumulate under the same name.
+// print() writes one line per phase in order of first appearance, e.g.
+//
+//   Phase=parse Time_s=0.612000 Share=48.1% MB_per_s=42.3 Medges_per_s=4.88
+//
+// followed by Phase=total with the wall time since the timer was created; the
+// drivers create it first thing in main().
+// Phases used by the drivers: generate, parse, csr_build, sort_dedup, bfs_seq,
+// bfs_par, validate, export, cc, scc, bc, closeness, diameter, pll_build,
+// landmarks, reach_build, serve, external_bfs, ingest.
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <ostream>
+#include <iomanip>
+using namespace std;
+
+inline double phase_now() {
+    using clk = chrono::steady_clock;
+    static const clk::time_point t0 = clk::now();
+    return chrono::duration<double>(clk::now() - t0).count();
+}
+
+class PhaseTimer {
+public:
+    PhaseTimer() : origin_(phase_now()) {}
+
+    // bytes: input/output volume (MB/s), items: edges processed (Medges/s)
+    void add(const char* name, double seconds, int64_t bytes = 0, int64_t items = 0) {
+        for (Phase& p : phases_)
+            if (strcmp(p.name, name) == 0) {
+                p.seconds += seconds; p.bytes += bytes; p.items += items;
+                return;
+            }
+        phases_.push_back({name, seconds, bytes, items});
+    }
+
+    void print(ostream& out) const {
+        const ios::fmtflags flags = out.flags();
+        const streamsize prec = out.precision();
+        const double total = phase_now() - origin_;
+        out << fixed;
+        for (const Phase& p : phases_) {
+            out << "Phase=" << p.name << " Time_s=" << setprecision(6) << p.seconds
+                << " Share=" << setprecision(1) << (total > 0 ? 100.0 * p.seconds / total : 0.0) << "%";
+            if (p.bytes && p.seconds > 0)
+                out << " MB_per_s=" << setprecision(1) << p.bytes / p.seconds / 1e6;
+            if (p.items && p.seconds > 0)
+                out << " Medges_per_s=" << setprecision(2) << p.items / p.seconds / 1e6;
+            out << "\n";
+        }
+        out << "Phase=total Time_s=" << setprecision(6) << total << "\n";
+        out.flags(flags);
+        out.precision(prec);
+    }
+
+private:
+    struct Phase {
+        const char* name;
+        double seconds;
+        int64_t bytes;
+        int64_t items;
+    };
+    vector<Phase> phases_;
+    double origin_;
+};
+
+inline PhaseTimer& phase_timer() { static PhaseTimer t; return t; }
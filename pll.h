@@ -0,0 +1,342 @@
+// pll.h
+// -----------------------------------------------------------------------------
+// Exact point-to-point distance index: pruned landmark labeling (Akiba et al.,
+// SIGMOD'13), a 2-hop cover. Used by bfs_par --pll-build / --pll.
+// -----------------------------------------------------------------------------
+//
+// Every vertex v gets a label L(v) of (hub, d(hub, v)) pairs such that for any
+// s, t some common hub lies on a shortest path, so
+//   dist(s, t) = min over hubs h in L_out(s) and L_in(t) of d(s, h) + d(h, t)
+// Undirected graphs have one label per vertex (L_out = L_in).
+//
+// Build: vertices are ranked by degree (highest first) and a BFS runs from
+// each in rank order. The BFS from root r reaching u at distance d adds
+// (rank(r), d) to L_in(u) - unless the labels built so far already give
+// dist(r, u) <= d, in which case u is neither labeled nor expanded. High-degree
+// hubs cover most shortest paths early, so later BFSs die out after a few
+// vertices. Directed graphs run the same pruned BFS over the reversed edges
+// for L_out. The build is serial: each BFS prunes against all earlier ones.
+//
+// Query: labels are sorted by hub, so dist(s, t) is a merge of two sorted
+// arrays. The hubs and distances are stored apart (structure of arrays); with
+// AVX2 (-mavx2 or -march=native) the merge compares blocks of 8 hubs against
+// all 8 rotations of the other block and takes the minimum distance sum over
+// the matching lanes without branching.
+//
+// File (PllFileHeader, then the arrays of each direction at kPllAlign-aligned
+// positions so the index can be mmap'ed and queried in place):
+//   offsets[n + 1] (uint64) into hubs/dists; hubs (uint32, rank) and dists
+//   (uint8) per entry, every label closed by a kPllSentinel hub.
+// Distances are stored in 8 bits; graphs with a shortest path longer than 254
+// are rejected at build time.
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include "graph_utils.h"
+#include "mem_utils.h"
+#include "graph_io.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+using namespace std;
+
+constexpr uint32_t kPllVersion = 1;
+constexpr uint32_t kPllDirected = 1;   // flags bit: separate in/out labels
+constexpr uint64_t kPllAlign = 4096;
+constexpr uint32_t kPllSentinel = UINT32_MAX;
+constexpr uint8_t kPllInf = 255;
+
+struct PllFileHeader {
+    char magic[8];               // "BFSPLL1" + NUL
+    uint32_t version;            // kPllVersion
+    uint32_t flags;              // kPllDirected
+    uint64_t n;
+    uint64_t entries[2];         // label entries incl. sentinels: [0] in, [1] out
+    uint64_t offsets_pos[2];
+    uint64_t hubs_pos[2];
+    uint64_t dists_pos[2];
+};
+static_assert(sizeof(PllFileHeader) == 88, "PllFileHeader layout");
+
+static const char kPllMagic[8] = {'B', 'F', 'S', 'P', 'L', 'L', '1', '\0'};
+
+// Labels of one direction, as built (owned arrays).
+struct PllLabels {
+    vector<uint64_t> offsets;
+    vector<uint32_t> hubs;
+    vector<uint8_t> dists;
+};
+
+// Read-only view of an index: arrays in memory or mmap'ed from a file.
+struct PllView {
+    int n = 0;
+    bool directed = false;
+    const uint64_t* offsets[2] = {nullptr, nullptr};   // [0] in, [1] out
+    const uint32_t* hubs[2] = {nullptr, nullptr};
+    const uint8_t* dists[2] = {nullptr, nullptr};
+
+    uint64_t entries() const {
+        return offsets[0][n] + (directed ? offsets[1][n] : 0);
+    }
+};
+
+// dist(s, t) from the sorted labels a = L_out(s), b = L_in(t); -1 if none.
+// Advancing both cursors with comparisons instead of branches keeps the loop
+// free of the unpredictable hub-order branch. A sum of two label distances
+// can reach 2 * 254, so "no common hub" is INT_MAX, not kPllInf.
+inline int pll_merge_scalar(const uint32_t* ha, const uint8_t* da, const uint32_t* hb, const uint8_t* db) {
+    int best = INT_MAX;
+    for (;;) {
+        const uint32_t a = *ha, b = *hb;
+        if (a == b) {
+            if (a == kPllSentinel) break;
+            best = min(best, *da + *db);
+        }
+        ha += a <= b; da += a <= b;
+        hb += b <= a; db += b <= a;
+    }
+    return best == INT_MAX ? -1 : best;
+}
+
+#ifdef __AVX2__
+// Blocks of 8 hubs of a against the 8 rotations of a block of b; the rotated
+// distances of b are added where the hubs match and a running minimum kept,
+// so matching blocks need no scalar pass.
+inline int pll_merge_avx2(const uint32_t* ha, const uint8_t* da, size_t na,
+                          const uint32_t* hb, const uint8_t* db, size_t nb) {
+    size_t i = 0, j = 0;
+    const __m256i rot = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+    const __m256i inf = _mm256_set1_epi32(INT_MAX);
+    __m256i best = inf;
+    while (i + 8 <= na && j + 8 <= nb) {
+        const __m256i va = _mm256_loadu_si256((const __m256i*)(ha + i));
+        const __m256i wa = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(da + i)));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(hb + j));
+        __m256i wb = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(db + j)));
+        for (int r = 0; r < 8; ++r) {
+            const __m256i eq = _mm256_cmpeq_epi32(va, vb);
+            best = _mm256_min_epi32(best, _mm256_blendv_epi8(inf, _mm256_add_epi32(wa, wb), eq));
+            vb = _mm256_permutevar8x32_epi32(vb, rot);
+            wb = _mm256_permutevar8x32_epi32(wb, rot);
+        }
+        const uint32_t la = ha[i + 7], lb = hb[j + 7];
+        i += (la <= lb) * 8;
+        j += (lb <= la) * 8;
+    }
+    // Horizontal minimum, then the scalar merge for the tails
+    __m128i m = _mm_min_epi32(_mm256_castsi256_si128(best), _mm256_extracti128_si256(best, 1));
+    m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+    m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+    int d = _mm_cvtsi128_si32(m);
+    const int tail = pll_merge_scalar(ha + i, da + i, hb + j, db + j);
+    if (tail >= 0) d = min(d, tail);
+    return d == INT_MAX ? -1 : d;
+}
+#endif
+
+// Exact distance s -> t, or -1 when t is unreachable.
+inline int pll_query(const PllView& ix, int s, int t) {
+    if (s == t) return 0;
+    const int out = ix.directed ? 1 : 0;
+    const uint64_t a0 = ix.offsets[out][s], b0 = ix.offsets[0][t];
+#ifdef __AVX2__
+    const size_t na = ix.offsets[out][s + 1] - a0 - 1, nb = ix.offsets[0][t + 1] - b0 - 1;
+    return pll_merge_avx2(ix.hubs[out] + a0, ix.dists[out] + a0, na, ix.hubs[0] + b0, ix.dists[0] + b0, nb);
+#else
+    return pll_merge_scalar(ix.hubs[out] + a0, ix.dists[out] + a0, ix.hubs[0] + b0, ix.dists[0] + b0);
+#endif
+}
+
+// Built index: L_in and, for directed graphs, L_out.
+struct PllIndex {
+    int n = 0;
+    bool directed = false;
+    PllLabels in, out;
+    vector<int> order;           // rank -> vertex
+
+    PllView view() const {
+        PllView v;
+        v.n = n; v.directed = directed;
+        v.offsets[0] = in.offsets.data(); v.hubs[0] = in.hubs.data(); v.dists[0] = in.dists.data();
+        const PllLabels& o = directed ? out : in;
+        v.offsets[1] = o.offsets.data(); v.hubs[1] = o.hubs.data(); v.dists[1] = o.dists.data();
+        return v;
+    }
+    size_t bytes() const {
+        return bytes_of(in.offsets) + bytes_of(in.hubs) + bytes_of(in.dists) +
+               bytes_of(out.offsets) + bytes_of(out.hubs) + bytes_of(out.dists);
+    }
+};
+
+// Builds the index. `rev` holds the reversed edges (g itself when undirected).
+// Returns false (with a message) when a distance does not fit in 8 bits.
+inline bool pll_build(const Graph& g, const Graph& rev, bool directed, PllIndex& ix) {
+    const int n = g.size();
+    ix.n = n; ix.directed = directed;
+    ix.order.resize(n);
+    for (int u = 0; u < n; ++u) ix.order[u] = u;
+    stable_sort(ix.order.begin(), ix.order.end(), [&](int a, int b) {
+        return g.degree(a) + rev.degree(a) > g.degree(b) + rev.degree(b);
+    });
+
+    // Labels under construction: per vertex, hubs in increasing rank
+    vector<vector<uint32_t>> hub[2];
+    vector<vector<uint8_t>> dst[2];
+    const int dirs = directed ? 2 : 1;
+    for (int d = 0; d < dirs; ++d) { hub[d].resize(n); dst[d].resize(n); }
+
+    vector<uint8_t> root_dist(n, kPllInf);  // by rank: d(root, hub) or d(hub, root)
+    vector<uint8_t> seen_d(n, kPllInf);
+    vector<int> q; q.reserve(n);
+    for (int rank = 0; rank < n; ++rank) {
+        const int r = ix.order[rank];
+        // dir 0: BFS over g fills L_in (d(r, u)), pruned by L_out(r) x L_in(u)
+        // dir 1: BFS over rev fills L_out (d(u, r)), pruned by L_out(u) x L_in(r)
+        for (int dir = 0; dir < dirs; ++dir) {
+            const Graph& G = dir == 0 ? g : rev;
+            const int src_side = directed ? 1 - dir : 0;
+            for (size_t i = 0; i < hub[src_side][r].size(); ++i)
+                root_dist[hub[src_side][r][i]] = dst[src_side][r][i];
+            q.clear(); q.push_back(r); seen_d[r] = 0;
+            for (size_t h = 0; h < q.size(); ++h) {
+                const int u = q[h];
+                const int du = seen_d[u];
+                bool pruned = false;
+                const vector<uint32_t>& hu = hub[dir][u];
+                for (size_t i = 0; i < hu.size() && !pruned; ++i)
+                    pruned = root_dist[hu[i]] + dst[dir][u][i] <= du;
+                if (pruned) continue;
+                hub[dir][u].push_back((uint32_t)rank);
+                dst[dir][u].push_back((uint8_t)du);
+                for (int v : G[u]) {
+                    if (seen_d[v] != kPllInf) continue;
+                    if (du + 1 >= kPllInf) {
+                        cerr << "Distance over " << (kPllInf - 1) << " does not fit the 8-bit labels\n";
+                        return false;
+                    }
+                    seen_d[v] = (uint8_t)(du + 1); q.push_back(v);
+                }
+            }
+            for (int v : q) seen_d[v] = kPllInf;
+            for (uint32_t h : hub[src_side][r]) root_dist[h] = kPllInf;
+        }
+    }
+
+    // Flatten into the sentinel-terminated arrays
+    for (int dir = 0; dir < dirs; ++dir) {
+        PllLabels& L = dir == 0 ? ix.in : ix.out;
+        L.offsets.assign(n + 1, 0);
+        for (int u = 0; u < n; ++u) L.offsets[u + 1] = L.offsets[u] + hub[dir][u].size() + 1;
+        L.hubs.resize(L.offsets[n]);
+        L.dists.resize(L.offsets[n]);
+        for (int u = 0; u < n; ++u) {
+            copy(hub[dir][u].begin(), hub[dir][u].end(), L.hubs.begin() + L.offsets[u]);
+            copy(dst[dir][u].begin(), dst[dir][u].end(), L.dists.begin() + L.offsets[u]);
+            L.hubs[L.offsets[u + 1] - 1] = kPllSentinel;
+            L.dists[L.offsets[u + 1] - 1] = kPllInf;
+            vector<uint32_t>().swap(hub[dir][u]);
+            vector<uint8_t>().swap(dst[dir][u]);
+        }
+    }
+    return true;
+}
+
+// Writes the index to `path` (see PllFileHeader); returns the bytes written or -1.
+inline int64_t pll_save(const PllIndex& ix, const string& path) {
+    auto align = [](uint64_t x) { return (x + kPllAlign - 1) / kPllAlign * kPllAlign; };
+    PllFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, kPllMagic, sizeof(h.magic));
+    h.version = kPllVersion;
+    h.flags = ix.directed ? kPllDirected : 0;
+    h.n = (uint64_t)ix.n;
+    uint64_t pos = align(sizeof(h));
+    const int dirs = ix.directed ? 2 : 1;
+    for (int d = 0; d < dirs; ++d) {
+        const PllLabels& L = d == 0 ? ix.in : ix.out;
+        h.entries[d] = L.hubs.size();
+        h.offsets_pos[d] = pos; pos = align(pos + L.offsets.size() * sizeof(uint64_t));
+        h.hubs_pos[d] = pos;    pos = align(pos + L.hubs.size() * sizeof(uint32_t));
+        h.dists_pos[d] = pos;   pos = pos + L.dists.size();
+        pos = align(pos);
+    }
+
+    ofstream f(path, ios::binary | ios::trunc);
+    if (!f) return -1;
+    auto put = [&](uint64_t at, const void* p, size_t len) {
+        f.seekp((streamoff)at);
+        f.write((const char*)p, (streamsize)len);
+    };
+    put(0, &h, sizeof(h));
+    for (int d = 0; d < dirs; ++d) {
+        const PllLabels& L = d == 0 ? ix.in : ix.out;
+        put(h.offsets_pos[d], L.offsets.data(), L.offsets.size() * sizeof(uint64_t));
+        put(h.hubs_pos[d], L.hubs.data(), L.hubs.size() * sizeof(uint32_t));
+        put(h.dists_pos[d], L.dists.data(), L.dists.size());
+    }
+    f.close();
+    return f.fail() ? -1 : (int64_t)pos;
+}
+
+// An index file opened for querying (MappedFile: mmap'ed where available).
+class PllFile {
+public:
+    bool open(const string& path) {
+        view_ = PllView();
+        if (!file_.open(path) || file_.size() < sizeof(PllFileHeader)) return false;
+        const char* base = file_.data();
+        PllFileHeader h;
+        memcpy(&h, base, sizeof(h));
+        if (memcmp(h.magic, kPllMagic, sizeof(h.magic)) != 0 || h.version != kPllVersion) {
+            file_.close();
+            return false;
+        }
+        const int dirs = (h.flags & kPllDirected) ? 2 : 1;
+        if (h.n >= (uint64_t)INT32_MAX) { file_.close(); return false; }
+        for (int d = 0; d < dirs; ++d)
+            if (!fits(h.offsets_pos[d], h.n + 1, sizeof(uint64_t)) || !fits(h.hubs_pos[d], h.entries[d], sizeof(uint32_t)) ||
+                !fits(h.dists_pos[d], h.entries[d], 1) || !labels_ok(base, h, d)) {
+                file_.close();
+                return false;
+            }
+        view_.n = (int)h.n;
+        view_.directed = dirs == 2;
+        for (int d = 0; d < 2; ++d) {
+            const int s = d < dirs ? d : 0;
+            view_.offsets[d] = (const uint64_t*)(base + h.offsets_pos[s]);
+            view_.hubs[d] = (const uint32_t*)(base + h.hubs_pos[s]);
+            view_.dists[d] = (const uint8_t*)(base + h.dists_pos[s]);
+        }
+        return true;
+    }
+
+    const PllView& view() const { return view_; }
+    size_t bytes() const { return file_.size(); }
+    bool mapped() const { return file_.mapped(); }
+
+private:
+    // count elements of `size` bytes at pos lie inside the file, aligned
+    bool fits(uint64_t pos, uint64_t count, uint64_t size) const {
+        return pos % size == 0 && pos <= file_.size() && count <= (file_.size() - pos) / size;
+    }
+    // Offsets start at 0, increase to entries, and every label is closed by a
+    // sentinel, so a merge never leaves its two labels
+    static bool labels_ok(const char* base, const PllFileHeader& h, int d) {
+        const uint64_t* off = (const uint64_t*)(base + h.offsets_pos[d]);
+        const uint32_t* hubs = (const uint32_t*)(base + h.hubs_pos[d]);
+        if (off[0] != 0 || off[h.n] != h.entries[d]) return false;
+        for (uint64_t u = 0; u < h.n; ++u)
+            if (off[u + 1] <= off[u] || hubs[off[u + 1] - 1] != kPllSentinel) return false;
+        return true;
+    }
+
+    MappedFile file_;
+    PllView view_;
+};
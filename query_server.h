@@ -0,0 +1,372 @@
+// query_server.h
+// -----------------------------------------------------------------------------
+// Long-running query server over a graph loaded once (bfs_par --serve).
+// -----------------------------------------------------------------------------
+//
+// Line protocol, one request per line, one response line per request:
+//   dist s t      -> "dist s t d"          shortest-path hops, -1 unreachable
+//   path s t      -> "path s t d v0 ... vd" a shortest path, "path s t -1" if none
+//   khop s k      -> "khop s k c"          vertices within k hops of s (incl. s)
+//   reach s t     -> "reach s t 0|1"
+//   info          -> "info n=... m=... directed=0|1 pll=0|1 reach=0|1"
+//   stats         -> "stats queries=... dist=... path=... khop=... reach=... errors=..."
+//                    (plus "cache_hits=... cache_misses=... cache_bytes=..." with --cache-mb)
+//   quit          closes the connection; shutdown stops the server
+// Malformed requests get "error <reason>".
+//
+// dist and reach use the --pll / --reach index when one is given (the mmap'ed
+// file, see pll.h and reach.h), otherwise bidirectional BFS; path always runs
+// bidirectional BFS, khop a depth-limited BFS. Each worker owns a
+// QueryWorkspace (BFS arrays sized for the graph, reset through the list of
+// touched vertices only), so a request allocates nothing and its latency is
+// that of its traversal.
+//
+// With --cache-mb, requests the indexes do not answer first look up their
+// source in the BfsCache (bfs_cache.h): a hit answers from the cached levels,
+// and a source that keeps missing gets one full BFS whose levels are cached
+// (the request that admits it is answered from them too).
+//
+// Transports:
+//   --serve <path>  Unix domain socket. The main thread accepts connections
+//                   and queues them; --serve-threads workers (default: the
+//                   OpenMP thread count) each serve one connection at a time
+//                   until the client closes it. All complete lines in a read
+//                   are answered with one write, so pipelined clients pay one
+//                   system call per batch. Connections beyond the worker count
+//                   wait in the queue. A line longer than kMaxRequestLine
+//                   gets "error line too long" and the connection is closed.
+//   --serve -       stdin/stdout, one request at a time (for scripting).
+// bfs_client drives the socket for load tests.
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <string>
+#include <deque>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <algorithm>
+#include <memory>
+#include <climits>
+#include "graph_utils.h"
+#include "bfs_kernels.h"
+#include "pll.h"
+#include "reach.h"
+#include "bfs_cache.h"
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+// What the server answers from: the graph, its reverse, optional indexes.
+struct QueryEngine {
+    const Graph* g = nullptr;
+    const Graph* rev = nullptr;        // g itself when undirected
+    bool directed = false;
+    const PllView* pll = nullptr;
+    const ReachView* reach = nullptr;
+    BfsCache* cache = nullptr;
+};
+
+enum QueryOp { kOpDist, kOpPath, kOpKhop, kOpReach, kOpCount };
+static const char* const kOpNames[kOpCount] = {"dist", "path", "khop", "reach"};
+
+// Served-request counters, shared by all workers.
+struct ServerStats {
+    atomic<int64_t> count[kOpCount];
+    atomic<int64_t> ns[kOpCount];      // service time, summed
+    atomic<int64_t> errors{0};
+    ServerStats() { for (int i = 0; i < kOpCount; ++i) { count[i] = 0; ns[i] = 0; } }
+};
+
+// Per-worker traversal state, allocated once.
+struct QueryWorkspace {
+    BidirScratch bidir;
+    ReachScratch reach;
+    vector<int> depth, frontier, next, touched, path;
+    string out;
+
+    QueryWorkspace(int n, int components) : bidir(n), reach(max(components, 1)), depth(n, -1) {}
+};
+
+// BFS from s up to k hops: w.touched gets the reached vertices in BFS order and
+// w.depth their levels (reset by the caller through w.touched).
+inline void khop_visit(const Graph& g, int s, int k, QueryWorkspace& w) {
+    w.frontier.assign(1, s);
+    w.touched.assign(1, s);
+    w.depth[s] = 0;
+    for (int d = 1; d <= k && !w.frontier.empty(); ++d) {
+        w.next.clear();
+        for (int u : w.frontier)
+            for (int v : g[u])
+                if (w.depth[v] < 0) { w.depth[v] = d; w.next.push_back(v); w.touched.push_back(v); }
+        w.frontier.swap(w.next);
+    }
+}
+
+// Vertices within k hops of s, s included.
+inline int64_t khop_count(const Graph& g, int s, int k, QueryWorkspace& w) {
+    khop_visit(g, s, k, w);
+    for (int v : w.touched) w.depth[v] = -1;
+    return (int64_t)w.touched.size();
+}
+
+// Cached levels of s: a hit, or a full BFS when the miss admits s; nullptr
+// otherwise (and always without a cache).
+inline shared_ptr<const LevelEntry> cached_levels(const QueryEngine& e, int s, QueryWorkspace& w) {
+    if (!e.cache) return nullptr;
+    shared_ptr<const LevelEntry> c = e.cache->find(s);
+    if (c || !e.cache->admit(s)) return c;
+    khop_visit(*e.g, s, INT_MAX, w);
+    c = level_entry_build(e.g->size(), s, w.touched, w.depth);
+    for (int v : w.touched) w.depth[v] = -1;
+    e.cache->insert(s, c);
+    return c;
+}
+
+// A shortest path s -> t from cached levels (t reached): walk back from t over
+// the reverse edges, each step to a vertex one level closer to s.
+inline void cached_path(const QueryEngine& e, const LevelEntry& c, int t, vector<int>& path) {
+    path.assign(1, t);
+    for (int v = t, l = c.level(t); l > 0; --l) {
+        for (int u : (*e.rev)[v])
+            if (c.level(u) == l - 1) { v = u; break; }
+        path.push_back(v);
+    }
+    reverse(path.begin(), path.end());
+}
+
+// Next whitespace-separated token of [p, end) as [*b, *e); false at the end.
+inline bool next_token(const char*& p, const char* end, const char** b, const char** e) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+    if (p == end) return false;
+    *b = p;
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\r') ++p;
+    *e = p;
+    return true;
+}
+
+inline bool parse_int(const char*& p, const char* end, long long* x) {
+    const char *b, *e;
+    if (!next_token(p, end, &b, &e)) return false;
+    long long v = 0;
+    for (const char* q = b; q < e; ++q) {
+        if (*q < '0' || *q > '9' || v > (1LL << 40)) return false;
+        v = v * 10 + (*q - '0');
+    }
+    *x = v;
+    return true;
+}
+
+// Answers one request line [p, end), appending the response line to w.out.
+// Returns false for quit/shutdown (*shutdown set for the latter).
+inline bool handle_query(const QueryEngine& e, const char* p, const char* end, QueryWorkspace& w,
+                         ServerStats& st, bool* shutdown) {
+    const char *ob, *oe;
+    if (!next_token(p, end, &ob, &oe)) return true;
+    const string_view op(ob, (size_t)(oe - ob));
+    if (op == "quit") return false;
+    if (op == "shutdown") { *shutdown = true; return false; }
+    const int n = e.g->size();
+    if (op == "info") {
+        w.out += "info n=" + to_string(n) + " m=" + to_string(e.g->num_edges()) +
+                 " directed=" + to_string((int)e.directed) + " pll=" + to_string((int)(e.pll != nullptr)) +
+                 " reach=" + to_string((int)(e.reach != nullptr)) + "\n";
+        return true;
+    }
+    if (op == "stats") {
+        int64_t total = 0;
+        for (int i = 0; i < kOpCount; ++i) total += st.count[i];
+        w.out += "stats queries=" + to_string(total);
+        for (int i = 0; i < kOpCount; ++i) w.out += string(" ") + kOpNames[i] + "=" + to_string(st.count[i].load());
+        w.out += " errors=" + to_string(st.errors.load());
+        if (e.cache) {
+            const BfsCache::Stats cs = e.cache->stats();
+            w.out += " cache_hits=" + to_string(cs.hits) + " cache_misses=" + to_string(cs.misses) +
+                     " cache_bytes=" + to_string(cs.bytes);
+        }
+        w.out += "\n";
+        return true;
+    }
+
+    int qop = -1;
+    for (int i = 0; i < kOpCount; ++i) if (op == kOpNames[i]) qop = i;
+    long long a, b;
+    if (qop < 0 || !parse_int(p, end, &a) || !parse_int(p, end, &b)) {
+        st.errors++;
+        w.out += qop < 0 ? "error unknown request\n" : "error expected two non-negative integers\n";
+        return true;
+    }
+    if (a >= n || (qop != kOpKhop && b >= n)) {
+        st.errors++;
+        w.out += "error vertex out of range\n";
+        return true;
+    }
+
+    const double t0 = wall();
+    const int s = (int)a, t = (int)min<long long>(b, n);
+    w.out += kOpNames[qop]; w.out += ' ';
+    w.out += to_string(s); w.out += ' ';
+    w.out += to_string(b); w.out += ' ';
+    // The indexes answer dist / reach without a traversal; anything else tries the cache
+    const bool indexed = (qop == kOpDist && e.pll) || (qop == kOpReach && e.reach);
+    const shared_ptr<const LevelEntry> c = indexed ? nullptr : cached_levels(e, s, w);
+    switch (qop) {
+    case kOpDist: {
+        const int d = e.pll ? pll_query(*e.pll, s, t)
+                    : c ? c->level(t) : bidir_bfs_distance(*e.g, *e.rev, s, t, w.bidir);
+        w.out += to_string(d);
+        break;
+    }
+    case kOpPath: {
+        const int d = c ? c->level(t) : bidir_bfs_distance(*e.g, *e.rev, s, t, w.bidir);
+        w.out += to_string(d);
+        if (d >= 0) {
+            if (c) cached_path(e, *c, t, w.path);
+            else bidir_bfs_path(w.bidir, s, t, w.path);
+            for (int v : w.path) { w.out += ' '; w.out += to_string(v); }
+        }
+        break;
+    }
+    case kOpKhop:
+        w.out += to_string(c ? c->within_k(t) : khop_count(*e.g, s, t, w));
+        break;
+    default: {
+        const bool r = e.reach ? reach_query(*e.reach, s, t, w.reach)
+                     : c ? c->level(t) >= 0 : bidir_bfs_distance(*e.g, *e.rev, s, t, w.bidir) >= 0;
+        w.out += r ? '1' : '0';
+    }
+    }
+    w.out += '\n';
+    st.count[qop]++;
+    st.ns[qop] += (int64_t)((wall() - t0) * 1e9);
+    return true;
+}
+
+// Serves requests from `in` to `out` until EOF, quit or shutdown.
+inline void serve_stream(const QueryEngine& e, istream& in, ostream& out, ServerStats& st) {
+    QueryWorkspace w(e.g->size(), e.reach ? e.reach->c : 0);
+    bool shutdown = false;
+    string line;
+    while (getline(in, line)) {
+        w.out.clear();
+        const bool more = handle_query(e, line.data(), line.data() + line.size(), w, st, &shutdown);
+        out << w.out << flush;
+        if (!more) break;
+    }
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;   // a closed client must not SIGPIPE us
+#else
+constexpr int kSendFlags = 0;
+#endif
+constexpr size_t kMaxRequestLine = 64 << 10;   // longer partial lines close the connection
+
+// Serves the Unix domain socket at `path` with `threads` workers until a
+// client sends shutdown. Returns false (with a message) if the socket fails.
+inline bool serve_socket(const QueryEngine& e, const string& path, int threads, ServerStats& st) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) { cerr << "Socket path too long\n"; return false; }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    const int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (lfd < 0) { cerr << "socket() failed\n"; return false; }
+    unlink(path.c_str());
+    if (bind(lfd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(lfd, 128) != 0) {
+        cerr << "Cannot listen on " << path << "\n";
+        close(lfd);
+        return false;
+    }
+
+    mutex mu;
+    condition_variable cv;
+    deque<int> pending;
+    vector<int> active;                // connections being served
+    atomic<bool> stop{false};
+    auto stop_all = [&]() {            // called with mu held
+        stop = true;
+        ::shutdown(lfd, SHUT_RDWR);    // wakes accept()
+        for (int fd : active) ::shutdown(fd, SHUT_RDWR);
+        cv.notify_all();
+    };
+
+    auto worker = [&]() {
+        QueryWorkspace w(e.g->size(), e.reach ? e.reach->c : 0);
+        string in;
+        char buf[65536];
+        for (;;) {
+            int fd;
+            {
+                unique_lock<mutex> lk(mu);
+                cv.wait(lk, [&] { return stop || !pending.empty(); });
+                if (stop) return;              // the main thread closes what is pending
+                fd = pending.front(); pending.pop_front();
+                active.push_back(fd);
+            }
+            in.clear();
+            bool open = true, stop_server = false;
+            while (open) {
+                const ssize_t r = recv(fd, buf, sizeof(buf), 0);
+                if (r <= 0) break;
+                in.append(buf, (size_t)r);
+                w.out.clear();
+                size_t begin = 0, nl;
+                while (open && (nl = in.find('\n', begin)) != string::npos) {
+                    bool shutdown = false;
+                    open = handle_query(e, in.data() + begin, in.data() + nl, w, st, &shutdown);
+                    begin = nl + 1;
+                    stop_server = stop_server || shutdown;
+                }
+                in.erase(0, begin);
+                if (in.size() > kMaxRequestLine) {
+                    st.errors++;
+                    w.out += "error line too long\n";
+                    open = false;
+                }
+                for (size_t off = 0; off < w.out.size(); ) {
+                    const ssize_t s = send(fd, w.out.data() + off, w.out.size() - off, kSendFlags);
+                    if (s <= 0) { open = false; break; }
+                    off += (size_t)s;
+                }
+                // Only after the replies to the earlier lines are out
+                if (stop_server) { lock_guard<mutex> lk(mu); stop_all(); }
+            }
+            lock_guard<mutex> lk(mu);
+            active.erase(find(active.begin(), active.end(), fd));
+            close(fd);
+        }
+    };
+
+    vector<thread> pool;
+    for (int i = 0; i < max(threads, 1); ++i) pool.emplace_back(worker);
+    while (!stop) {
+        const int fd = accept(lfd, nullptr, nullptr);
+        if (fd < 0) { if (stop) break; continue; }
+        lock_guard<mutex> lk(mu);
+        pending.push_back(fd);
+        cv.notify_one();
+    }
+    {
+        lock_guard<mutex> lk(mu);
+        stop = true;
+        for (int fd : pending) close(fd);
+        pending.clear();
+    }
+    cv.notify_all();
+    for (thread& t : pool) t.join();
+    close(lfd);
+    unlink(path.c_str());
+    return true;
+}
+#endif
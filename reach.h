@@ -0,0 +1,267 @@
+// reach.h
+// -----------------------------------------------------------------------------
+// Directed reachability index over the SCC condensation. Used by bfs_par
+// --reach-build / --reach.
+// -----------------------------------------------------------------------------
+//
+// u reaches v iff comp(u) reaches comp(v) in the condensation DAG (scc.h), so
+// the index is built on the DAG and a query first maps both vertices to their
+// components cu, cv:
+//   1. cu == cv                          -> yes (same SCC)
+//   2. cu > cv                           -> no  (IDs are in topological order)
+//   3. some label interval of cv is not
+//      inside the matching one of cu     -> no  (GRAIL, Yildirim et al.,
+//                                                VLDB'10)
+//   4. otherwise a DFS over the DAG from cu that only enters components with
+//      ID <= cv whose intervals contain cv's (the same filters as 2 and 3).
+// Steps 1-3 are O(k); the fallback is the only step that walks the DAG. The
+// fallbacks that end in "no" are the false positives of the labels
+// (Reach_fallback_no, Reach_label_false_positive).
+//
+// Labels: each of the k traversals is a DFS over the DAG from the sources in
+// random order, visiting children from a random rotation of the row, that
+// gives every component c its post-order rank post(c) and
+//   low(c) = min(post(c), low of every child)
+// If c reaches d then [low(d), post(d)] lies inside [low(c), post(c)] in every
+// traversal; the random orders make the converse fail on different pairs, so
+// more traversals (--reach-labels) filter more. The k traversals run in
+// parallel.
+//
+// File (ReachFileHeader, then kReachAlign-aligned arrays, mmap'ed by --reach):
+//   comp[n] (int32), dag offsets[c + 1] (int64), dag adj[m] (int32),
+//   labels[c * k] (low, post as uint32 pairs; the k intervals of a component
+//   are adjacent).
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include "graph_utils.h"
+#include "mem_utils.h"
+#include "graph_io.h"
+#include "scc.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+using namespace std;
+
+constexpr uint32_t kReachVersion = 1;
+constexpr uint64_t kReachAlign = 4096;
+
+struct ReachFileHeader {
+    char magic[8];           // "BFSRCH1" + NUL
+    uint32_t version;        // kReachVersion
+    uint32_t k;              // intervals per component
+    uint64_t n;              // vertices
+    uint64_t c;              // components
+    uint64_t m;              // DAG edges
+    uint64_t comp_pos;
+    uint64_t offsets_pos;
+    uint64_t adj_pos;
+    uint64_t labels_pos;
+};
+static_assert(sizeof(ReachFileHeader) == 72, "ReachFileHeader layout");
+
+static const char kReachMagic[8] = {'B', 'F', 'S', 'R', 'C', 'H', '1', '\0'};
+
+struct ReachInterval { uint32_t low, post; };
+
+// Read-only view of an index: arrays in memory or mmap'ed from a file.
+struct ReachView {
+    int n = 0, c = 0, k = 0;
+    const int* comp = nullptr;
+    const int64_t* offsets = nullptr;
+    const int* adj = nullptr;
+    const ReachInterval* labels = nullptr;
+
+    // Every interval of component b inside the matching one of a
+    bool contains(int a, int b) const {
+        const ReachInterval* la = labels + (size_t)a * k;
+        const ReachInterval* lb = labels + (size_t)b * k;
+        bool in = true;
+        for (int i = 0; i < k; ++i) in &= la[i].low <= lb[i].low && lb[i].post <= la[i].post;
+        return in;
+    }
+};
+
+// How a query was answered.
+enum ReachHow { kReachSameScc, kReachTopoCut, kReachLabelCut, kReachFallbackYes, kReachFallbackNo, kReachHowCount };
+static const char* const kReachHowNames[kReachHowCount] = {
+    "same_scc", "topo_cut", "label_cut", "fallback_yes", "fallback_no"
+};
+
+// Per-thread fallback state: a DFS stack and visit stamps.
+struct ReachScratch {
+    vector<uint32_t> stamp;
+    vector<int> stack;
+    uint32_t epoch = 0;
+    explicit ReachScratch(int c) : stamp(c, 0) {}
+};
+
+// Can u reach v? `how` (optional) receives the step that decided.
+inline bool reach_query(const ReachView& ix, int u, int v, ReachScratch& w, ReachHow* how = nullptr) {
+    const int cu = ix.comp[u], cv = ix.comp[v];
+    ReachHow h;
+    bool yes = false;
+    if (cu == cv) { h = kReachSameScc; yes = true; }
+    else if (cu > cv) h = kReachTopoCut;
+    else if (!ix.contains(cu, cv)) h = kReachLabelCut;
+    else {
+        if (++w.epoch == 0) { fill(w.stamp.begin(), w.stamp.end(), 0); w.epoch = 1; }
+        w.stack.assign(1, cu);
+        w.stamp[cu] = w.epoch;
+        while (!w.stack.empty() && !yes) {
+            const int x = w.stack.back(); w.stack.pop_back();
+            for (int64_t j = ix.offsets[x]; j < ix.offsets[x + 1]; ++j) {
+                const int y = ix.adj[j];
+                if (y == cv) { yes = true; break; }
+                if (y > cv || w.stamp[y] == w.epoch || !ix.contains(y, cv)) continue;
+                w.stamp[y] = w.epoch;
+                w.stack.push_back(y);
+            }
+        }
+        h = yes ? kReachFallbackYes : kReachFallbackNo;
+    }
+    if (how) *how = h;
+    return yes;
+}
+
+// Built index (owned arrays).
+struct ReachIndex {
+    int k = 0;
+    Sccs scc;
+    vector<ReachInterval> labels;
+    double scc_s = 0, label_s = 0;
+
+    ReachView view() const {
+        ReachView v;
+        v.n = (int)scc.id.size(); v.c = scc.count(); v.k = k;
+        v.comp = scc.id.data();
+        v.offsets = scc.dag.offsets.data();
+        v.adj = scc.dag.adj.data();
+        v.labels = labels.data();
+        return v;
+    }
+    size_t bytes() const {
+        return bytes_of(scc.id) + scc.dag.bytes() + bytes_of(labels);
+    }
+};
+
+// One randomized DFS labeling of the DAG into labels[c * k + i].
+inline void reach_label(const Graph& dag, int i, int k, uint64_t seed, ReachInterval* labels) {
+    const int c = dag.size();
+    mt19937_64 rng(seed + (uint64_t)i * 0x9e3779b97f4a7c15ULL);
+    vector<int> indeg(c, 0), roots;
+    for (int x : dag.adj) indeg[x]++;
+    for (int x = 0; x < c; ++x) if (indeg[x] == 0) roots.push_back(x);
+    shuffle(roots.begin(), roots.end(), rng);
+
+    vector<uint8_t> visited(c, 0);
+    vector<uint32_t> low(c);
+    struct Frame { int x; int next, start, deg; };
+    vector<Frame> call;
+    uint32_t rank = 0;
+    for (int r : roots) {
+        auto enter = [&](int x) {
+            visited[x] = 1;
+            low[x] = UINT32_MAX;
+            const int deg = dag.degree(x);
+            call.push_back({x, 0, deg ? (int)(rng() % (uint64_t)deg) : 0, deg});
+        };
+        enter(r);
+        while (!call.empty()) {
+            Frame& f = call.back();
+            if (f.next < f.deg) {
+                const int y = dag[f.x][(f.start + f.next++) % f.deg];
+                if (!visited[y]) { enter(y); continue; }
+                low[f.x] = min(low[f.x], labels[(size_t)y * k + i].low);
+                continue;
+            }
+            const int x = f.x;
+            call.pop_back();
+            const uint32_t post = ++rank;
+            labels[(size_t)x * k + i] = {min(low[x], post), post};
+            if (!call.empty()) low[call.back().x] = min(low[call.back().x], labels[(size_t)x * k + i].low);
+        }
+    }
+}
+
+// SCCs (fwbw) and k label traversals of the condensation.
+inline void reach_build(const Graph& g, const Graph& rev, int k, uint64_t seed, ReachIndex& ix) {
+    double t = wall();
+    ix.scc = scc_fwbw(g, rev);
+    ix.scc_s = wall() - t;
+    ix.k = k;
+    t = wall();
+    ix.labels.assign((size_t)ix.scc.count() * k, ReachInterval{0, 0});
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int i = 0; i < k; ++i) reach_label(ix.scc.dag, i, k, seed, ix.labels.data());
+    ix.label_s = wall() - t;
+}
+
+// Writes the index to `path` (see ReachFileHeader); returns the bytes written or -1.
+inline int64_t reach_save(const ReachIndex& ix, const string& path) {
+    auto align = [](uint64_t x) { return (x + kReachAlign - 1) / kReachAlign * kReachAlign; };
+    const ReachView v = ix.view();
+    ReachFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, kReachMagic, sizeof(h.magic));
+    h.version = kReachVersion;
+    h.k = (uint32_t)v.k;
+    h.n = (uint64_t)v.n; h.c = (uint64_t)v.c; h.m = (uint64_t)ix.scc.dag.num_edges();
+    uint64_t pos = align(sizeof(h));
+    h.comp_pos = pos;    pos = align(pos + h.n * sizeof(int));
+    h.offsets_pos = pos; pos = align(pos + (h.c + 1) * sizeof(int64_t));
+    h.adj_pos = pos;     pos = align(pos + h.m * sizeof(int));
+    h.labels_pos = pos;  pos = pos + h.c * h.k * sizeof(ReachInterval);
+
+    ofstream f(path, ios::binary | ios::trunc);
+    if (!f) return -1;
+    auto put = [&](uint64_t at, const void* p, size_t len) {
+        f.seekp((streamoff)at);
+        f.write((const char*)p, (streamsize)len);
+    };
+    put(0, &h, sizeof(h));
+    put(h.comp_pos, v.comp, h.n * sizeof(int));
+    put(h.offsets_pos, v.offsets, (h.c + 1) * sizeof(int64_t));
+    put(h.adj_pos, v.adj, h.m * sizeof(int));
+    put(h.labels_pos, v.labels, h.c * h.k * sizeof(ReachInterval));
+    f.close();
+    return f.fail() ? -1 : (int64_t)pos;
+}
+
+// An index file opened for querying (MappedFile: mmap'ed where available).
+class ReachFile {
+public:
+    bool open(const string& path) {
+        view_ = ReachView();
+        if (!file_.open(path) || file_.size() < sizeof(ReachFileHeader)) return false;
+        const char* base = file_.data();
+        ReachFileHeader h;
+        memcpy(&h, base, sizeof(h));
+        if (memcmp(h.magic, kReachMagic, sizeof(h.magic)) != 0 || h.version != kReachVersion ||
+            h.labels_pos + h.c * h.k * sizeof(ReachInterval) > file_.size()) {
+            file_.close();
+            return false;
+        }
+        view_.n = (int)h.n; view_.c = (int)h.c; view_.k = (int)h.k;
+        view_.comp = (const int*)(base + h.comp_pos);
+        view_.offsets = (const int64_t*)(base + h.offsets_pos);
+        view_.adj = (const int*)(base + h.adj_pos);
+        view_.labels = (const ReachInterval*)(base + h.labels_pos);
+        return true;
+    }
+
+    const ReachView& view() const { return view_; }
+    size_t bytes() const { return file_.size(); }
+    bool mapped() const { return file_.mapped(); }
+
+private:
+    MappedFile file_;
+    ReachView view_;
+};
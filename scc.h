@@ -0,0 +1,259 @@
+// scc.h
+// -----------------------------------------------------------------------------
+// Strongly connected components of a directed graph and its condensation DAG.
+// Used by bfs_par --scc.
+// -----------------------------------------------------------------------------
+//
+// Two variants over the out-CSR g and the in-CSR rev (transpose(g); g itself
+// for undirected graphs, whose SCCs are the connected components):
+//
+//   fwbw    1. Trim: a vertex without in-edges or without out-edges from the
+//              unassigned vertices is an SCC of its own. Remaining in/out
+//              degrees are kept in atomic counters and trimmed vertices
+//              decrement their neighbors', so chains peel off in parallel
+//              rounds of a worklist.
+//           2. Forward-backward (Fleischer et al., Hong et al. SC'13): the
+//              SCC of a pivot is the intersection of what it reaches and what
+//              reaches it. The pivot is the untrimmed vertex with the largest
+//              product of (full-graph) in- and out-degree, almost always inside
+//              the giant SCC; both sides are bfs_openmp_level runs, over g and rev.
+//              Trimmed vertices cannot be on both sides, so the BFS runs on
+//              the full graph.
+//           3. Tarjan on what is left (small after the giant is gone).
+//   tarjan  Iterative Tarjan over the whole graph (serial; the reference).
+//
+// The result is an Sccs object: component IDs in topological order of the
+// condensation (an edge u -> v implies id[u] <= id[v]), sizes, and the
+// condensation DAG as a CSR Graph over the IDs with sorted, deduplicated
+// rows. A vertex can only reach vertices whose ID is not smaller, which is
+// what directed reachability queries build on.
+// -----------------------------------------------------------------------------
+
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include "graph_utils.h"
+#include "mem_utils.h"
+#include "bfs_kernels.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+using namespace std;
+
+struct Sccs {
+    page_vector<int> id;        // topological component ID per vertex
+    vector<int64_t> size;       // vertices per component
+    Graph dag;                  // condensation: id -> ids it has edges to
+    int largest = -1;           // ID of the largest component
+    int64_t trimmed = 0;        // fwbw: vertices removed by trimming
+    int64_t giant = 0;          // fwbw: vertices of the pivot's SCC
+    int64_t remainder = 0;      // fwbw: vertices left to Tarjan
+    double trim_s = 0, fwbw_s = 0, tarjan_s = 0, dag_s = 0;
+
+    int count() const { return (int)size.size(); }
+    bool same(int u, int v) const { return id[u] == id[v]; }
+
+    // Longest path in the condensation, in edges
+    int dag_depth() const {
+        vector<int> depth(count(), 0);
+        int d = 0;
+        for (int c = 0; c < count(); ++c) {
+            for (int w : dag[c]) depth[w] = max(depth[w], depth[c] + 1);
+            d = max(d, depth[c]);
+        }
+        return d;
+    }
+};
+
+// Trim vertices with no remaining in- or out-edges, repeatedly; they become
+// singleton components (root[v] = v). Returns the number trimmed.
+inline int64_t scc_trim(const Graph& g, const Graph& rev, int* root) {
+    const int n = g.size();
+    vector<int> indeg(n), outdeg(n);
+    vector<int> frontier;
+    #pragma omp parallel for schedule(static)
+    for (int u = 0; u < n; ++u) { indeg[u] = rev.degree(u); outdeg[u] = g.degree(u); }
+    for (int u = 0; u < n; ++u)
+        if (indeg[u] == 0 || outdeg[u] == 0) { root[u] = u; frontier.push_back(u); }
+
+    int64_t trimmed = 0;
+    while (!frontier.empty()) {
+        trimmed += (int64_t)frontier.size();
+        vector<int> next;
+        #pragma omp parallel
+        {
+            vector<int> local;
+            #pragma omp for schedule(dynamic, 256) nowait
+            for (size_t i = 0; i < frontier.size(); ++i) {
+                const int v = frontier[i];
+                auto drop = [&](int w, int* deg) {
+                    if (__atomic_sub_fetch(&deg[w], 1, __ATOMIC_RELAXED) != 0) return;
+                    int expected = -1;
+                    if (__atomic_compare_exchange_n(&root[w], &expected, w, false,
+                                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                        local.push_back(w);
+                };
+                for (int w : g[v]) drop(w, indeg.data());
+                for (int w : rev[v]) drop(w, outdeg.data());
+            }
+            #pragma omp critical(scc_trim)
+            next.insert(next.end(), local.begin(), local.end());
+        }
+        frontier.swap(next);
+    }
+    return trimmed;
+}
+
+// Iterative Tarjan over the vertices with root[v] == -1 (edges into assigned
+// vertices are ignored); each new SCC gets its first-completed vertex as root.
+inline void scc_tarjan(const Graph& g, int* root) {
+    const int n = g.size();
+    vector<int> index(n, -1), low(n, 0), stack;
+    vector<uint8_t> on_stack(n, 0);
+    vector<pair<int, int64_t>> call;   // (vertex, next edge position)
+    int counter = 0;
+    for (int r = 0; r < n; ++r) {
+        if (root[r] != -1 || index[r] != -1) continue;
+        auto enter = [&](int v) {
+            index[v] = low[v] = counter++;
+            stack.push_back(v); on_stack[v] = 1;
+            call.push_back({v, g.offsets[v]});
+        };
+        enter(r);
+        while (!call.empty()) {
+            const int v = call.back().first;
+            int64_t& pos = call.back().second;
+            if (pos < g.offsets[v + 1]) {
+                const int w = g.adj[pos++];
+                if (root[w] != -1) continue;   // assigned before or completed
+                if (index[w] == -1) enter(w);
+                else if (on_stack[w]) low[v] = min(low[v], index[w]);
+                continue;
+            }
+            call.pop_back();
+            if (!call.empty()) low[call.back().first] = min(low[call.back().first], low[v]);
+            if (low[v] == index[v]) {
+                int w;
+                do {
+                    w = stack.back(); stack.pop_back();
+                    on_stack[w] = 0;
+                    root[w] = v;
+                } while (w != v);
+            }
+        }
+    }
+}
+
+// Roots -> topologically ordered dense IDs, sizes and the condensation DAG.
+inline void scc_finish(const Graph& g, const int* root, Sccs& s) {
+    const int n = g.size();
+    vector<int> dense(n, -1);
+    int k = 0;
+    for (int u = 0; u < n; ++u) if (dense[root[u]] < 0) dense[root[u]] = k++;
+
+    // Cross-component edges, deduplicated
+    vector<pair<int, int>> edges;
+    #pragma omp parallel
+    {
+        vector<pair<int, int>> local;
+        #pragma omp for schedule(dynamic, 4096) nowait
+        for (int u = 0; u < n; ++u) {
+            const int cu = dense[root[u]];
+            for (int v : g[u]) {
+                const int cv = dense[root[v]];
+                if (cu != cv) local.push_back({cu, cv});
+            }
+        }
+        #pragma omp critical(scc_finish)
+        edges.insert(edges.end(), local.begin(), local.end());
+    }
+    sort(edges.begin(), edges.end());
+    edges.erase(unique(edges.begin(), edges.end()), edges.end());
+
+    // Kahn's algorithm gives each component its topological position
+    vector<int> indeg(k, 0), order;
+    vector<int64_t> off(k + 1, 0);
+    for (auto& e : edges) { off[e.first + 1]++; indeg[e.second]++; }
+    for (int c = 0; c < k; ++c) off[c + 1] += off[c];
+    order.reserve(k);
+    for (int c = 0; c < k; ++c) if (indeg[c] == 0) order.push_back(c);
+    for (size_t i = 0; i < order.size(); ++i)
+        for (int64_t j = off[order[i]]; j < off[order[i] + 1]; ++j)
+            if (--indeg[edges[j].second] == 0) order.push_back(edges[j].second);
+    vector<int> pos(k);
+    for (int i = 0; i < k; ++i) pos[order[i]] = i;
+
+    s.id.resize(n);
+    s.size.assign(k, 0);
+    #pragma omp parallel for schedule(static)
+    for (int u = 0; u < n; ++u) s.id[u] = pos[dense[root[u]]];
+    for (int u = 0; u < n; ++u) s.size[s.id[u]]++;
+    s.largest = (int)(max_element(s.size.begin(), s.size.end()) - s.size.begin());
+
+    // DAG rows in the new numbering; sources stay grouped, targets get sorted
+    for (auto& e : edges) { e.first = pos[e.first]; e.second = pos[e.second]; }
+    sort(edges.begin(), edges.end());
+    s.dag.offsets.resize(k + 1);
+    first_touch_fill(s.dag.offsets.data(), s.dag.offsets.size(), int64_t(0));
+    for (auto& e : edges) s.dag.offsets[e.first + 1]++;
+    for (int c = 0; c < k; ++c) s.dag.offsets[c + 1] += s.dag.offsets[c];
+    s.dag.adj.resize(edges.size());
+    for (size_t i = 0; i < edges.size(); ++i) s.dag.adj[i] = edges[i].second;
+}
+
+// Trim, forward-backward for the giant SCC, Tarjan for the rest.
+inline Sccs scc_fwbw(const Graph& g, const Graph& rev) {
+    const int n = g.size();
+    Sccs s;
+    vector<int> root(n, -1);
+
+    double t = wall();
+    s.trimmed = scc_trim(g, rev, root.data());
+    s.trim_s = wall() - t;
+
+    // Pivot: the largest in * out degree among the unassigned vertices
+    t = wall();
+    int pivot = -1;
+    int64_t best = -1;
+    for (int u = 0; u < n; ++u) {
+        if (root[u] != -1) continue;
+        const int64_t score = (int64_t)g.degree(u) * rev.degree(u);
+        if (score > best) { best = score; pivot = u; }
+    }
+    if (pivot >= 0) {
+        page_vector<int> fw, bw;
+        bfs_openmp_level(g, pivot, &fw);
+        bfs_openmp_level(rev, pivot, &bw);
+        int64_t giant = 0;
+        #pragma omp parallel for schedule(static) reduction(+:giant)
+        for (int u = 0; u < n; ++u)
+            if (fw[u] >= 0 && bw[u] >= 0 && root[u] == -1) { root[u] = pivot; giant++; }
+        s.giant = giant;
+    }
+    s.fwbw_s = wall() - t;
+
+    t = wall();
+    s.remainder = n - s.trimmed - s.giant;
+    scc_tarjan(g, root.data());
+    s.tarjan_s = wall() - t;
+
+    t = wall();
+    scc_finish(g, root.data(), s);
+    s.dag_s = wall() - t;
+    return s;
+}
+
+// Serial Tarjan over the whole graph.
+inline Sccs scc_tarjan_all(const Graph& g) {
+    Sccs s;
+    vector<int> root(g.size(), -1);
+    double t = wall();
+    scc_tarjan(g, root.data());
+    s.remainder = g.size();
+    s.tarjan_s = wall() - t;
+    t = wall();
+    scc_finish(g, root.data(), s);
+    s.dag_s = wall() - t;
+    return s;
+}